@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <utility>
+#include <unistd.h>
+#include <benchmark/benchmark.h>
+#include "Bagging.hpp"
+#include "Calculations.hpp"
+#include "DataReader.hpp"
+#include "DecisionTree.hpp"
+#include "SyntheticData.hpp"
+#include "TreeTest.hpp"
+
+/*
+ * Microbenchmarks of the training and inference stages over a scaling curve of
+ * synthetic data sets (8 numeric and 4 categorical attributes, 4 classes). The
+ * first argument of every benchmark is the number of training rows, the test
+ * set has a quarter of them. Rows per second are reported as items_per_second;
+ * --benchmark_format=json or --benchmark_out=<file> give machine-readable results.
+ * The sparse benchmarks use 200 numeric attributes of which 2% are not 0,
+ * written in the sparse ARFF format.
+ */
+
+namespace {
+
+constexpr int64_t minRows = 1 << 10;
+constexpr int64_t maxRows = 1 << 16;
+
+/**
+ * Method that returns a generated data set in the temp directory. Its name
+ * holds the generator version and all options, so a file is only reused for
+ * the same data; it is written under a unique name and renamed into place,
+ * so a half-written file is never picked up.
+ */
+std::string dataFile(size_t rows, bool test, bool sparse) {
+  Synthetic::Options options;
+  options.rows = test ? rows / 4 : rows;
+  options.seed = test ? 4321 : 1234;
+  if (sparse) {
+    options.numeric = 200;
+    options.categorical = 0;
+    options.density = 0.02;
+    options.sparse = true;
+  }
+
+  std::ostringstream name;
+  name << "decisiontree-benchmark-v" << Synthetic::version << "-" << options.rows << "-" << options.numeric << "-"
+       << options.categorical << "-" << options.cardinality << "-" << options.classes << "-" << options.noise << "-"
+       << options.density << (options.sparse ? "-sparse-" : "-dense-") << options.seed << "-" << options.conceptSeed << ".arff";
+  const auto path = std::filesystem::temp_directory_path() / name.str();
+  if (!std::filesystem::exists(path)) {
+    const auto temporary = path.string() + "." + std::to_string(getpid()) + ".tmp";
+    Synthetic::writeArff(temporary, options);
+    std::filesystem::rename(temporary, path);
+  }
+  return path.string();
+}
+
+Dataset dataset(size_t rows, bool sparse = false) {
+  Dataset d;
+  d.train.filename = dataFile(rows, false, sparse);
+  d.test.filename = dataFile(rows, true, sparse);
+  d.classLabel = "class";
+  return d;
+}
+
+/**
+ * Method that returns the parsed data set with the given number of training
+ * rows, it is generated and read once per size.
+ */
+DataReader* reader(size_t rows, bool sparse = false) {
+  static std::map<std::pair<size_t, bool>, std::unique_ptr<DataReader>> readers;
+  auto& dr = readers[{rows, sparse}];
+  if (!dr)
+    dr = std::make_unique<DataReader>(dataset(rows, sparse));
+  return dr.get();
+}
+
+std::vector<size_t> allRows(const DataTable& data) {
+  std::vector<size_t> indexes(data.rows());
+  std::iota(indexes.begin(), indexes.end(), 0);
+  return indexes;
+}
+
+TreeOptions singleThreaded(Splitter splitter = Splitter::Exact) {
+  TreeOptions options;
+  options.splitter = splitter;
+  options.threads = 1;
+  return options;
+}
+
+void BM_DataReader(benchmark::State& state) {
+  const Dataset d = dataset(state.range(0));
+  const size_t bytes = std::filesystem::file_size(d.train.filename) + std::filesystem::file_size(d.test.filename);
+  size_t rows = 0;
+  for (auto _: state) {
+    DataReader dr(d);
+    rows = dr.trainData().rows() + dr.testData().rows();
+    benchmark::DoNotOptimize(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * rows);
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_DataReader)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMillisecond);
+
+void BM_FindBestSplit(benchmark::State& state) {
+  const DataTable& data = reader(state.range(0))->trainData();
+  const std::vector<size_t> indexes = allRows(data);
+  const std::vector<size_t> columns = Calculations::allColumns(data);
+  for (auto _: state) {
+    auto split = Calculations::find_best_split(data, indexes, nullptr, columns, 1);
+    benchmark::DoNotOptimize(split);
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+}
+BENCHMARK(BM_FindBestSplit)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMicrosecond);
+
+void BM_DetermineBestThreshold(benchmark::State& state) {
+  const DataTable& data = reader(state.range(0))->trainData();
+  const std::vector<size_t> indexes = allRows(data);
+  const std::vector<int> counts = Calculations::classCounts(data, indexes);
+  const int column = state.range(1);
+  for (auto _: state) {
+    auto threshold = Calculations::determine_best_threshold(data, column, indexes, nullptr, counts, 1);
+    benchmark::DoNotOptimize(threshold);
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+  state.SetLabel(data.isNumeric(column) ? "numeric" : "categorical");
+}
+BENCHMARK(BM_DetermineBestThreshold)
+    ->ArgsProduct({benchmark::CreateRange(minRows, maxRows, 4), {0, 8}}) // a numeric and a categorical column
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Partition(benchmark::State& state) {
+  const DataTable& data = reader(state.range(0))->trainData();
+  std::vector<size_t> indexes = allRows(data);
+  const Question question(0, 50.0f);
+  for (auto _: state) {
+    //partitioning the previous result again is as much work as the first time
+    size_t* middle = Calculations::partition(data, question, indexes.data(), indexes.data() + indexes.size());
+    benchmark::DoNotOptimize(middle);
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+}
+BENCHMARK(BM_Partition)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMicrosecond);
+
+void BM_BuildTree(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0));
+  const TreeOptions options = singleThreaded(static_cast<Splitter>(state.range(1)));
+  size_t leaves = 0;
+  for (auto _: state) {
+    DecisionTree tree(dr, options);
+    leaves = tree.flat().leaves();
+  }
+  state.SetItemsProcessed(state.iterations() * dr->trainData().rows());
+  state.counters["leaves"] = leaves;
+  state.SetLabel(std::array<const char*, 3>{"exact", "presorted", "histogram"}[state.range(1)]);
+}
+BENCHMARK(BM_BuildTree)
+    ->ArgsProduct({benchmark::CreateRange(minRows, maxRows, 4), {0, 1, 2}}) // Splitter::Exact, Presorted, Histogram
+    ->Unit(benchmark::kMillisecond);
+
+void BM_SparseFindBestSplit(benchmark::State& state) {
+  const DataTable& data = reader(state.range(0), true)->trainData();
+  const std::vector<size_t> indexes = allRows(data);
+  const std::vector<size_t> columns = Calculations::allColumns(data);
+  for (auto _: state) {
+    auto split = Calculations::find_best_split(data, indexes, nullptr, columns, 1);
+    benchmark::DoNotOptimize(split);
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+  state.SetLabel(data.isSparse() ? "sparse" : "dense");
+}
+BENCHMARK(BM_SparseFindBestSplit)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMicrosecond);
+
+void BM_SparseBuildTree(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0), true);
+  const TreeOptions options = singleThreaded(static_cast<Splitter>(state.range(1)));
+  size_t leaves = 0;
+  for (auto _: state) {
+    DecisionTree tree(dr, options);
+    leaves = tree.flat().leaves();
+  }
+  state.SetItemsProcessed(state.iterations() * dr->trainData().rows());
+  state.counters["leaves"] = leaves;
+  state.SetLabel(std::array<const char*, 3>{"exact", "presorted", "histogram"}[state.range(1)]);
+}
+BENCHMARK(BM_SparseBuildTree)
+    ->ArgsProduct({benchmark::CreateRange(minRows, maxRows, 4), {0, 1, 2}}) // Splitter::Exact, Presorted, Histogram
+    ->Unit(benchmark::kMillisecond);
+
+void BM_Classify(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0));
+  const auto tree = std::make_unique<DecisionTree>(dr, singleThreaded());
+  const std::shared_ptr<Node> root = tree->root();
+  const DataTable& data = dr->testData();
+  const TreeTest treeTest;
+  for (auto _: state)
+    for (size_t row = 0; row < data.rows(); row++) {
+      auto counts = treeTest.classify(data, row, root);
+      benchmark::DoNotOptimize(counts);
+    }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+}
+BENCHMARK(BM_Classify)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMicrosecond);
+
+void BM_Predict(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0));
+  const auto tree = std::make_unique<DecisionTree>(dr, singleThreaded());
+  const DataTable& data = dr->testData();
+  std::vector<Category> predictions(data.rows());
+  for (auto _: state) {
+    tree->predict(data, predictions.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+}
+BENCHMARK(BM_Predict)->RangeMultiplier(4)->Range(minRows, maxRows)->Unit(benchmark::kMicrosecond);
+
+void BM_BaggingTrain(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0));
+  const int trees = state.range(1);
+  for (auto _: state) {
+    Bagging bag(dr, trees, 1234, singleThreaded());
+    benchmark::DoNotOptimize(bag.oobAccuracy());
+  }
+  state.SetItemsProcessed(state.iterations() * trees * dr->trainData().rows());
+}
+BENCHMARK(BM_BaggingTrain)
+    ->ArgsProduct({benchmark::CreateRange(minRows, maxRows, 4), {10}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_BaggingPredict(benchmark::State& state) {
+  DataReader* dr = reader(state.range(0));
+  const int trees = state.range(1);
+  const auto bag = std::make_unique<Bagging>(dr, trees, 1234, singleThreaded());
+  const DataTable& data = dr->testData();
+  std::vector<Category> predictions(data.rows());
+  for (auto _: state) {
+    bag->predict(data, predictions.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * data.rows());
+}
+BENCHMARK(BM_BaggingPredict)
+    ->ArgsProduct({benchmark::CreateRange(minRows, maxRows, 4), {10}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iostream>
+#include <string>
+#include "SyntheticData.hpp"
+
+/**
+ * Writes a synthetic data set, e.g.
+ *   generate_arff data.arff --rows=100000 --numeric=10 --categorical=5 --cardinality=20 --classes=7
+ *   generate_arff sparse.arff --rows=100000 --numeric=500 --categorical=0 --density=0.02 --sparse
+ */
+int main(int argc, char** argv) {
+  const std::string usage = "usage: generate_arff <file> [--rows=N] [--numeric=N] [--categorical=N] "
+                            "[--cardinality=N] [--classes=N] [--noise=X] [--density=X] [--sparse] [--seed=N] [--concept-seed=N]";
+  if (argc < 2) {
+    std::cerr << usage << std::endl;
+    return 1;
+  }
+
+  Synthetic::Options options;
+  try {
+    for (int i = 2; i < argc; i++) {
+      const std::string arg = argv[i];
+      const size_t equals = arg.find('=');
+      const std::string key = arg.substr(0, equals);
+      const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+      if (key == "--rows")
+        options.rows = std::stoull(value);
+      else if (key == "--numeric")
+        options.numeric = std::stoull(value);
+      else if (key == "--categorical")
+        options.categorical = std::stoull(value);
+      else if (key == "--cardinality")
+        options.cardinality = std::stoull(value);
+      else if (key == "--classes")
+        options.classes = std::stoull(value);
+      else if (key == "--noise")
+        options.noise = std::stod(value);
+      else if (key == "--density")
+        options.density = std::stod(value);
+      else if (key == "--sparse")
+        options.sparse = true;
+      else if (key == "--seed")
+        options.seed = std::stoull(value);
+      else if (key == "--concept-seed")
+        options.conceptSeed = std::stoull(value);
+      else
+        throw std::invalid_argument("unknown option " + arg);
+    }
+    Synthetic::writeArff(argv[1], options);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n" << usage << std::endl;
+    return 1;
+  }
+  return 0;
+}
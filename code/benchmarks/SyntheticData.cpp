@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "SyntheticData.hpp"
+
+namespace Synthetic {
+
+/**
+ * Method that writes a synthetic data set, see Synthetic.
+ *
+ * @param filename - path of the ARFF file, overwritten
+ * @param options - shape of the data set
+ */
+void writeArff(const std::string& filename, const Options& options) {
+  if (options.classes == 0 || (options.categorical > 0 && options.cardinality == 0))
+    throw std::invalid_argument("A synthetic data set needs at least one class and one value per categorical attribute");
+
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Can't write file: " + filename);
+
+  file << "@RELATION synthetic\n\n";
+  for (size_t i = 0; i < options.numeric; i++)
+    file << "@ATTRIBUTE n" << i << " NUMERIC\n";
+  for (size_t i = 0; i < options.categorical; i++) {
+    file << "@ATTRIBUTE c" << i << " {";
+    for (size_t value = 0; value < options.cardinality; value++)
+      file << (value > 0 ? "," : "") << "v" << value;
+    file << "}\n";
+  }
+  file << "@ATTRIBUTE class {";
+  for (size_t value = 0; value < options.classes; value++)
+    file << (value > 0 ? "," : "") << value;
+  file << "}\n\n@DATA\n";
+
+  std::mt19937_64 random(options.seed);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::uniform_int_distribution<size_t> category(0, std::max<size_t>(options.cardinality, 1) - 1);
+  std::uniform_int_distribution<size_t> anyClass(0, options.classes - 1);
+
+  //every value of a categorical attribute shifts the class by a fixed random amount, drawn apart from the rows
+  std::mt19937_64 concept(options.conceptSeed);
+  std::vector<double> effects(options.categorical * options.cardinality);
+  for (auto& effect: effects)
+    effect = uniform(concept);
+
+  //the class depends on the first 3 numeric and the first 2 categorical attributes
+  const size_t relevantNumeric = std::min<size_t>(options.numeric, 3);
+  const size_t relevantCategorical = std::min<size_t>(options.categorical, 2);
+  std::vector<double> numeric(options.numeric);
+  std::vector<size_t> categorical(options.categorical);
+  std::string line;
+  char value[32];
+  for (size_t row = 0; row < options.rows; row++) {
+    for (auto& x: numeric)
+      x = uniform(random) < options.density ? uniform(random) : 0;
+    for (auto& c: categorical)
+      c = category(random);
+
+    double score = 0;
+    for (size_t i = 0; i < relevantNumeric; i++)
+      score += numeric[i];
+    for (size_t i = 0; i < relevantCategorical; i++)
+      score += effects[i * options.cardinality + categorical[i]];
+    const size_t relevant = relevantNumeric + relevantCategorical;
+    score = relevant > 0 ? score / relevant : uniform(random);
+    size_t label = std::min<size_t>(score * options.classes, options.classes - 1);
+    if (uniform(random) < options.noise)
+      label = anyClass(random);
+
+    line.clear();
+    if (options.sparse) {
+      //categorical values and the class are always written, since 0 would mean their first value
+      line += "{";
+      for (size_t i = 0; i < numeric.size(); i++) {
+        std::snprintf(value, sizeof(value), "%zu %.2f,", i, 100 * numeric[i]);
+        if (100 * numeric[i] >= 0.005)
+          line += value;
+      }
+      for (size_t i = 0; i < categorical.size(); i++)
+        line += std::to_string(numeric.size() + i) + " v" + std::to_string(categorical[i]) + ",";
+      line += std::to_string(numeric.size() + categorical.size()) + " " + std::to_string(label) + "}\n";
+    } else {
+      for (const auto& x: numeric) {
+        std::snprintf(value, sizeof(value), "%.2f,", 100 * x);
+        line += value;
+      }
+      for (const auto& c: categorical)
+        line += "v" + std::to_string(c) + ",";
+      line += std::to_string(label) + "\n";
+    }
+    file << line;
+  }
+
+  if (!file)
+    throw std::runtime_error("Can't write file: " + filename);
+}
+
+} // namespace Synthetic
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_SYNTHETICDATA_HPP
+#define DECISIONTREE_SYNTHETICDATA_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Generator of synthetic ARFF data sets for the benchmarks. Numeric attributes
+ * are uniform in [0, 100) and come first, categorical attributes draw one of
+ * their values uniformly. The class is the bucketed mean of the first numeric
+ * and categorical attributes, so trees find real structure, with a share of
+ * the rows relabeled at random. With a density below 1, the other numeric
+ * values are 0, and sparse writes the rows in the sparse ARFF format
+ * ({index value, ...}, zeros left out). The same options always give the same
+ * file. The concept, i.e. how the attributes determine the class, comes from
+ * conceptSeed and the rows from seed, so a training and a test set drawn with
+ * different seeds share their concept.
+ */
+namespace Synthetic {
+
+constexpr int version = 2; // raised whenever the same options give a different file
+
+struct Options {
+  size_t rows = 10000;
+  size_t numeric = 8;
+  size_t categorical = 4;
+  size_t cardinality = 8; // values of every categorical attribute
+  size_t classes = 4;
+  double noise = 0.1; // share of the rows with a random class
+  double density = 1; // share of the numeric values that are not 0
+  bool sparse = false;
+  uint64_t seed = 1234; // draws the rows
+  uint64_t conceptSeed = 1; // draws the effects of the categorical values
+};
+
+void writeArff(const std::string& filename, const Options& options); // class attribute "class", the last one
+
+} // namespace Synthetic
+
+#endif //DECISIONTREE_SYNTHETICDATA_HPP
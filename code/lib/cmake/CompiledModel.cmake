@@ -0,0 +1,14 @@
+# add_compiled_model(<target> <source>)
+#
+# Builds a source written by CodeGenerator into a shared library that exports
+# predict(const float*), predict_proba, num_features, num_classes and
+# class_name with C linkage; everything else stays hidden. The generated code
+# has no dependencies.
+function(add_compiled_model target source)
+    add_library(${target} SHARED ${source})
+    set_target_properties(${target} PROPERTIES
+            CXX_STANDARD 17
+            CXX_VISIBILITY_PRESET hidden
+            POSITION_INDEPENDENT_CODE ON)
+    target_compile_options(${target} PRIVATE -O2)
+endfunction()
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_ARFFSTREAM_HPP
+#define DECISIONTREE_ARFFSTREAM_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "DataTable.hpp"
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
+
+/**
+ * Reader that streams the data section of an ARFF file in blocks of lines,
+ * for data sets that do not fit in memory. Only one block is held at a time
+ * and the stream can be rewound for another pass over the file.
+ */
+class ArffStream {
+  public:
+    ArffStream(const std::string& filename, const std::string& classLabel, size_t blockBytes);
+
+    inline const MetaData& metaData() const { return meta_; } // attributes, with the class label moved to the back
+
+    void rewind();
+    bool next(DataTable& block, const MetaData& schema, ThreadPool& pool);
+
+  private:
+    std::ifstream file_;
+    MetaData meta_;
+    std::vector<size_t> columns_; // column of every attribute of the file in a block
+    std::streampos dataStart_;
+    size_t blockBytes_;
+    std::string buffer_;
+    std::string carry_; // start of a line that continues in the next block
+};
+
+#endif //DECISIONTREE_ARFFSTREAM_HPP
@@ -7,12 +7,14 @@
 #ifndef DECISIONTREE_BAGGING_HPP
 #define DECISIONTREE_BAGGING_HPP
 
+#include <mutex>
 #include <random>
-#include <boost/chrono.hpp>
 #include "Dataset.hpp"
 #include "DecisionTree.hpp"
 #include "Calculations.hpp"
 #include "DataReader.hpp"
+#include "Forest.hpp"
+#include "ThreadPool.hpp"
 #include "TreeTest.hpp"
 
 using std::shared_ptr;
@@ -20,20 +22,38 @@ using std::shared_ptr;
 class Bagging {
   public:
     Bagging() = delete;
-    explicit Bagging(DataReader *dr, const int ensembleSize, uint seed = 1234);
+    explicit Bagging(DataReader *dr, const int ensembleSize, uint seed = 1234, const TreeOptions& options = TreeOptions());
 
     void test() const;
-    const std::vector<size_t> sampleData(int size) const; //used to create a sample of data
-
-    inline Data testData() { return dr_->testData(); }
+    void prune(); //cost-complexity pruning of every tree on its out-of-bag rows
+    void save(const std::string& filename) const;
+    void generateCode(const std::string& filename) const; //standalone C++ source, see CodeGenerator
+    static Bagging load(const std::string& filename, const TreeOptions& options = TreeOptions());
+    void predict(const DataTable& data, size_t begin, size_t end, Category* out) const; //majority vote of the trees
+    void predict(const DataTable& data, Category* out) const;
+    const Weights sampleData(int size, int tree) const; //used to create the sample of a tree
+
+    inline const DataTable& testData() const { return dr_->testData(); }
+    inline double oobAccuracy() const { return oobAccuracy_; } //over the training rows that were out of bag for at least one tree
+    inline const std::vector<int>& oobVotes() const { return oobVotes_; } //per training row, numClasses votes of the trees that did not draw it
 
   private:
     DataReader* dr_; //changed to pointer, to reduce the memory overhead
     int ensembleSize_;
+    TreeOptions options_;
+    mutable std::shared_ptr<ThreadPool> pool_; //the pool the trees were trained on, kept for predictions, or created by the first large batch
     std::vector<DecisionTree> learners_;
-    std::mt19937_64 random_number_generator;
+    Forest forest_; //all learners compiled for inference
+    uint seed_;
+    std::vector<int> oobVotes_; //empty for restored models
+    double oobAccuracy_;
 
+    Bagging(std::vector<DecisionTree> learners, const TreeOptions& options); //restored model, inference only
     void buildBag();
+    void voteOutOfBag(const DecisionTree& tree, const Weights& weights, std::mutex& mutex);
+    void computeOobAccuracy();
+    void buildForest();
+    std::vector<const FlatTree*> flatTrees() const;
 };
 
 #endif //DECISIONTREE_BAGGING_HPP
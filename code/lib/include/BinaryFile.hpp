@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_BINARYFILE_HPP
+#define DECISIONTREE_BINARYFILE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include "Utils.hpp"
+
+namespace BinaryFile {
+
+inline bool littleEndian() {
+  const uint32_t one = 1;
+  return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+constexpr size_t padding(size_t offset) {
+  return (8 - offset % 8) % 8;
+}
+
+template <size_t Size>
+using Unsigned = std::conditional_t<Size == 1, uint8_t,
+                 std::conditional_t<Size == 2, uint16_t,
+                 std::conditional_t<Size == 4, uint32_t, uint64_t>>>;
+
+/**
+ * Sequential writer for the binary files of the library. Scalars and string
+ * lengths are stored little-endian, every section can be padded to 8 bytes so
+ * arrays that follow can be used in place once the file is mapped.
+ */
+class Writer {
+  public:
+    explicit Writer(const std::string& filename) : file_(filename, std::ios::binary), offset_(0) {}
+
+    void bytes(const void* data, size_t size) {
+      file_.write(static_cast<const char*>(data), size);
+      offset_ += size;
+    }
+
+    template <typename T>
+    void value(const T& value) {
+      static_assert(std::is_arithmetic<T>::value, "only scalars have a byte order");
+      Unsigned<sizeof(T)> bits;
+      std::memcpy(&bits, &value, sizeof(T));
+      uint8_t out[sizeof(T)];
+      for (size_t i = 0; i < sizeof(T); i++)
+        out[i] = static_cast<uint8_t>(uint64_t(bits) >> (8 * i));
+      bytes(out, sizeof(T));
+    }
+
+    template <typename T>
+    void values(const T* data, size_t count) {
+      if (littleEndian()) {
+        bytes(data, count * sizeof(T));
+        return;
+      }
+      for (size_t i = 0; i < count; i++)
+        value(data[i]);
+    }
+
+    void text(const std::string& value);
+    void texts(const VecS& values);
+    void meta(const MetaData& meta);
+    void align();
+
+    inline bool good() const { return file_.good(); }
+
+  private:
+    std::ofstream file_;
+    size_t offset_;
+};
+
+/**
+ * Reader over a file in memory, usually a MappedFile. Reading past the end
+ * throws std::runtime_error.
+ */
+class Reader {
+  public:
+    Reader(const char* data, size_t size) : data_(data), size_(size), offset_(0) {}
+
+    const char* bytes(size_t size);
+
+    template <typename T>
+    T value() {
+      const uint8_t* in = reinterpret_cast<const uint8_t*>(bytes(sizeof(T)));
+      Unsigned<sizeof(T)> bits = 0;
+      for (size_t i = 0; i < sizeof(T); i++)
+        bits |= Unsigned<sizeof(T)>(in[i]) << (8 * i);
+      T value;
+      std::memcpy(&value, &bits, sizeof(T));
+      return value;
+    }
+
+    std::string text();
+    VecS texts();
+    MetaData meta();
+    void align();
+
+    inline size_t remaining() const { return size_ - offset_; }
+
+  private:
+    const char* data_;
+    size_t size_;
+    size_t offset_;
+};
+
+} // namespace BinaryFile
+
+#endif //DECISIONTREE_BINARYFILE_HPP
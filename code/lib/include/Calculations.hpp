@@ -11,27 +11,55 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
-#include <boost/timer/timer.hpp>
+#include "DataTable.hpp"
+#include "Histogram.hpp"
+#include "IndexRange.hpp"
 #include "Question.hpp"
 #include "Utils.hpp"
 
-using ClassCounter = std::unordered_map<std::string, int>;
+class ThreadPool;
+
+using ClassCounter = std::unordered_map<Category, int>;
+using SortedIndexes = std::vector<std::vector<size_t>>; // per column, the rows of a node ordered on that column
+using Weights = std::vector<int>; // per row of the data set, how many times it counts (e.g. how often a bootstrap drew it)
 
 namespace Calculations {
 
-std::tuple<const std::vector<size_t>, const std::vector<size_t>> partition(const Data &data, const Question &q, const std::vector<size_t>& indexes); // changed so that it partitions indexes instead the data
+size_t* partition(const DataTable &data, const Question &q, size_t* begin, size_t* end); // in place, returns the end of the true rows
+
+size_t partition(const DataTable &data, const Question &q, SortedIndexes& sorted, size_t begin, size_t end); // in place and stable in every column, returns the end of the true rows
+
+const double gini(const int* counts, size_t numClasses, double N); // dense class counts, indexed by class id
+
+const double gini(const int64_t* counts, size_t numClasses, double N); // counts of a histogram
+
+const double sum_of_squares(const int* counts, size_t n); // vectorized when compiled with AVX2 or SSE2
+
+const double sum_of_squares(const int64_t* counts, size_t n);
+
+// only the given columns (in increasing order) are evaluated, ties go to the first of them
+// a split is only considered when both branches get at least minLeaf rows
+// with a pool, the columns are evaluated in parallel; the result is the same as without one
+// without weights (nullptr) every row counts once
+std::tuple<const double, const Question> find_best_split(const DataTable &rows, IndexRange indexes, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool = nullptr);
+
+std::tuple<const double, const Question> find_best_split(const DataTable &rows, const SortedIndexes& sorted, size_t begin, size_t end, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool = nullptr); // rows [begin, end) of every column
+
+std::tuple<const double, const Question> find_best_split(const DataTable &rows, const Binning& binning, const Histogram& histogram, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool = nullptr);
+
+std::tuple<const Question, double> determine_best_threshold(const DataTable &data, int col, IndexRange indexes, const int* weights, const std::vector<int>& counter, size_t minLeaf);
 
-const double gini(const ClassCounter& counts, double N);
+std::tuple<const Question, double> determine_best_bin(const DataTable &data, int col, const Binning& binning, const Histogram& histogram, const std::vector<int64_t>& counter, size_t minLeaf);
 
-std::tuple<const double, const Question> find_best_split(const Data &rows, const MetaData &meta, const std::vector<size_t>& indexes);
+const std::vector<int> classCounts(const DataTable &data, IndexRange indexes, const int* weights = nullptr); // dense, indexed by class id
 
-std::tuple<std::string, double> determine_best_threshold(const Data &data, int col, const std::vector<size_t>& indexes, const ClassCounter& counter);
+const std::vector<size_t> allColumns(const DataTable &data); // 0, 1, ..., columns - 1
 
-const ClassCounter copy(const ClassCounter &counter); //used to make a copy of class counter
+const ClassCounter toClassCounter(const std::vector<int>& counts); //used to store the counts in a leaf
 
-const ClassCounter empty(const ClassCounter &counter); // used to make an empty copy of class counter
+const SortedIndexes presort(const DataTable &data, const std::vector<size_t>& indexes); //sorts the indexes once on every column
 
-const ClassCounter classCounts(const Data &data, const std::vector<size_t>& indexes);
+const SortedIndexes sample(const SortedIndexes &sorted, const Weights& weights); //presorted order of the rows with a weight, without sorting
 
 } // namespace Calculations
 
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_CODEGENERATOR_HPP
+#define DECISIONTREE_CODEGENERATOR_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "FlatTree.hpp"
+#include "Utils.hpp"
+
+/**
+ * Generator of standalone C++ sources for trained trees.
+ *
+ * Every tree becomes a function of labelled branches in depth-first order,
+ * with its thresholds and feature indexes as constants, so the compiler can
+ * specialize it completely while the source stays flat for deep trees.
+ * The source has no dependencies and exports, with C linkage:
+ *
+ *   int predict(const float* features);                // class id
+ *   void predict_proba(const float* features, float* out); // num_classes() values
+ *   int num_features(); int num_classes(); const char* class_name(int id);
+ *
+ * class_name returns an empty string for an id that is not a class.
+ *
+ * features holds one value per feature column, in the order of the schema
+ * labels. Categorical features are passed as their category id (see the
+ * dictionaries listed at the top of the file); a value that is not an id,
+ * such as a negative one or -infinity for missing, is in no category set.
+ * An ensemble predicts the majority vote of its trees, ties going to the
+ * lowest class id, and its probabilities are the fractions of the votes.
+ *
+ * Use add_compiled_model() from cmake/CompiledModel.cmake to build the source
+ * into a shared library.
+ */
+namespace CodeGenerator {
+  void generate(std::ostream& out, const std::vector<const FlatTree*>& trees, const MetaData& schema);
+  void generate(const std::string& filename, const std::vector<const FlatTree*>& trees, const MetaData& schema);
+}
+
+#endif //DECISIONTREE_CODEGENERATOR_HPP
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_COSTCOMPLEXITY_HPP
+#define DECISIONTREE_COSTCOMPLEXITY_HPP
+
+#include <cstdint>
+#include <vector>
+#include "DataTable.hpp"
+#include "IndexRange.hpp"
+#include "NodeArena.hpp"
+
+/**
+ * Minimal cost-complexity pruning (CART) of a trained tree.
+ *
+ * The cost of a subtree T is R(T) + alpha * |leaves of T|, where R is the
+ * share of the training rows it misclassifies. For every alpha there is a
+ * smallest subtree of minimal cost, and a node is a leaf of it or removed from
+ * it once alpha reaches the node's pruning alpha. All pruning alphas are
+ * computed in one bottom-up pass: the minimal cost of the subtree of a node as
+ * a function of alpha is concave and piecewise linear, the sum of its children's
+ * until it meets the cost of the node as a leaf, and the pruning alpha of a
+ * node is that meeting point, or the pruning alpha of its parent when that is
+ * lower. The distinct pruning alphas form the pruning path.
+ */
+class CostComplexity {
+  public:
+    CostComplexity(const NodeArena& arena, uint32_t root);
+
+    std::vector<double> path() const; // 0 and the distinct pruning alphas, increasing; alpha 0 keeps the training error of the full tree
+    double select(const DataTable& data, IndexRange rows) const; // alpha of the path with the highest accuracy on the rows
+    uint32_t prune(double alpha, NodeArena& pruned) const; // subtree of minimal cost, returns its root in pruned
+
+    inline double alpha(uint32_t node) const { return alphas_[node]; } // infinity for leaves
+
+  private:
+    const NodeArena& arena_;
+    uint32_t root_;
+    std::vector<int> counts_; // numClasses counts per node
+    std::vector<double> alphas_; // pruning alpha per node
+
+    Category majority(uint32_t node) const;
+};
+
+#endif //DECISIONTREE_COSTCOMPLEXITY_HPP
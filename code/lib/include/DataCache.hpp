@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_DATACACHE_HPP
+#define DECISIONTREE_DATACACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include "DataTable.hpp"
+#include "Utils.hpp"
+
+/**
+ * Binary columnar copy of a parsed ARFF file.
+ *
+ * The cache holds the meta data, the category dictionaries and the typed
+ * columns of one file, every column 8-byte aligned, so it can be opened with
+ * mmap and used without copying or parsing. It records the format version,
+ * the byte order, the class label and the size and modification time of the
+ * source file; a cache that does not match them is stale and is not used.
+ *
+ * Layout: header, strings (class label, meta data, dictionaries), then one
+ * array of rows floats or category ids per feature column and one for the class.
+ */
+class DataCache {
+  public:
+    static constexpr uint32_t version = 1;
+
+    static inline std::string path(const std::string& source) { return source + ".cache"; }
+
+    static bool read(const std::string& cache, const std::string& source, const std::string& classLabel,
+                     DataTable& data, MetaData& meta);
+    static bool write(const std::string& cache, const std::string& source, const std::string& classLabel,
+                      const DataTable& data, const MetaData& meta);
+};
+
+#endif //DECISIONTREE_DATACACHE_HPP
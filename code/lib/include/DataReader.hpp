@@ -9,16 +9,22 @@
 
 #include <iostream>
 #include <fstream>
+#include <string_view>
 #include <vector>
 #include <boost/algorithm/string.hpp>
 #include "Dataset.hpp"
+#include "DataTable.hpp"
+#include "ThreadPool.hpp"
 #include "Utils.hpp"
 
 /**
  * Implementation of a parser for data sets in the ARFF format.
  *
  * The specification of the Attribute-Relation File Format (ARFF) can be found
- * at <https://www.cs.waikato.ac.nz/ml/weka/arff.html>.
+ * at <https://www.cs.waikato.ac.nz/ml/weka/arff.html>. Rows can be dense or
+ * sparse ({index value, ...}); the training data is indexed for sparse split
+ * finding when most of its numeric values are 0. Malformed rows are skipped
+ * and counted, see DataTable::skippedRows.
  *
  * TODO: A working implementation is provided, although you might want to make
  * some changes to enable faster decision tree learning. The definition of the
@@ -31,22 +37,27 @@ class DataReader
     DataReader() = delete;
     DataReader(const Dataset& d);
 
-    inline const Data& trainData() const { return trainData_; }
-    inline const Data& testData() const { return testData_; }
+    inline const DataTable& trainData() const { return trainData_; }
+    inline const DataTable& testData() const { return testData_; }
     inline const MetaData& metaData() const { return trainMetaData_; }
 
   private:
-    void processFile(const std::string& strings, Data& data, MetaData &meta);
-    void moveClassDataToBack(VecS &line, const VecS &labels) const;
-    void moveClassLabelToBack();
-    void trimWhiteSpaces(VecS &line);
+    friend class ArffStream; //shares the parsing functions below
 
-    bool parseHeaderLine(const std::string& line, MetaData &meta, bool &header_loaded);
-    bool parseDataLine(const std::string& line, Data &data, MetaData &meta);
+    void processFile(const std::string& filename, DataTable& data, MetaData &meta, ThreadPool& pool, Profiler* profiler);
+    static void parseRows(std::string_view rows, DataTable &data, const MetaData &meta, const std::vector<size_t> &columns, ThreadPool& pool);
+    static DataTable parseChunk(std::string_view chunk, const MetaData &meta, const std::vector<size_t> &columns);
+    static const std::vector<size_t> moveClassLabelToBack(MetaData &meta, const std::string& classLabel);
+    static void trimWhiteSpaces(VecS &line);
+
+    static bool parseHeaderLine(const std::string& line, MetaData &meta, bool &header_loaded);
+    static bool parseDataLine(std::string_view line, DataTable &data, const std::vector<size_t> &columns);
+    static bool parseSparseLine(std::string_view line, DataTable &data, const std::vector<size_t> &columns);
 
     const std::string classLabel_;
-    Data trainData_;
-    Data testData_;
+    const bool useCache_;
+    DataTable trainData_;
+    DataTable testData_;
     MetaData trainMetaData_;
     MetaData testMetaData_;
 
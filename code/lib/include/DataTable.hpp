@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_DATATABLE_HPP
+#define DECISIONTREE_DATATABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Utils.hpp"
+
+using Category = uint32_t;
+
+class DataCache;
+class MappedFile;
+
+/**
+ * Column oriented, typed representation of a data set.
+ *
+ * NUMERIC features are stored as contiguous float arrays, CATEGORICAL
+ * features and the class label are dictionary-encoded to small integer ids.
+ * The class label is kept apart from the features, so feature column i
+ * corresponds to MetaData::labels[i] and the class to MetaData::labels.back().
+ *
+ * The columns are read through plain pointers, which point either into the
+ * vectors of the table or, for a table opened from a DataCache, straight into
+ * the mapped cache file. A mapped table copies its columns into vectors of its
+ * own the first time it is modified.
+ *
+ * A table whose numeric columns are mostly zero can also be indexed by row:
+ * indexSparse() lists, per row, the numeric columns whose value is not 0, so
+ * split finding only has to visit those entries (CSR). The index is dropped
+ * when rows are appended.
+ */
+class DataTable {
+  public:
+    DataTable();
+    explicit DataTable(const MetaData& meta);
+    DataTable(const DataTable& other);
+    DataTable(DataTable&& other) = default;
+    DataTable& operator=(const DataTable& other);
+    DataTable& operator=(DataTable&& other) = default;
+
+    void append(size_t column, std::string_view cell);
+    void append(size_t column, float value); // numeric columns, a cell parsed with parseNumeric
+    void appendClass(std::string_view cell);
+    void append(const DataTable& rows); // appends the rows of a table with the same columns, e.g. a parsed chunk
+    void conform(const DataTable& reference); // re-encodes categories with the dictionaries of reference
+    DataTable select(const std::vector<size_t>& rows) const; // copy with only the given rows and the same dictionaries
+    MetaData schema(const MetaData& meta) const; // meta data whose domains are the dictionaries of this table
+    inline void skipRow() { skipped_++; } // counts a malformed row that was left out
+    void indexSparse(); // builds the index of the non-zero numeric values, only when they are at most sparseDensity of them
+
+    inline size_t rows() const { return rows_; }
+    inline size_t skippedRows() const { return skipped_; } // malformed rows left out while parsing, not kept in a DataCache
+    inline size_t columns() const { return numericColumn_.size(); }
+    inline size_t numClasses() const { return classDictionary_.values.size(); }
+    inline bool isNumeric(size_t column) const { return numericColumn_[column]; }
+
+    inline const float* numeric(size_t column) const { return numericView_[column]; }
+    inline const Category* categories(size_t column) const { return categoricalView_[column]; }
+    inline const Category* classes() const { return classesView_; }
+    inline bool isMapped() const { return mapping_ != nullptr; }
+
+    static constexpr double sparseDensity = 0.25;
+    inline bool isSparse() const { return !nonZeroStarts_.empty(); }
+    inline size_t nonZeroStart(size_t row) const { return nonZeroStarts_[row]; } // entries of a row are [nonZeroStart(row), nonZeroStart(row + 1))
+    inline const uint32_t* nonZeroColumns() const { return nonZeroColumns_.data(); } // column of every entry, increasing within a row
+
+    inline const VecS& dictionary(size_t column) const { return dictionaries_[column].values; }
+    inline const VecS& classNames() const { return classDictionary_.values; }
+
+    static bool parseNumeric(std::string_view cell, float& value); // false when the cell is neither a number nor '?'
+
+  private:
+    friend class DataCache;
+
+    struct Dictionary {
+      Dictionary() : values({}), ids({}) {}
+
+      VecS values;
+      std::unordered_multimap<size_t, Category> ids; // hash of a value to its id, looked up without copying the value
+
+      Category encode(std::string_view value);
+    };
+
+    std::vector<bool> numericColumn_;
+    std::vector<std::vector<float>> numeric_; // empty for categorical columns
+    std::vector<std::vector<Category>> categorical_; // empty for numeric columns
+    std::vector<Dictionary> dictionaries_;
+    std::vector<Category> classes_;
+    Dictionary classDictionary_;
+    size_t rows_;
+    size_t skipped_;
+
+    std::shared_ptr<const MappedFile> mapping_; // set when the columns live in a mapped cache file
+    std::vector<const float*> numericView_;
+    std::vector<const Category*> categoricalView_;
+    const Category* classesView_;
+
+    std::vector<size_t> nonZeroStarts_; // rows + 1 offsets into nonZeroColumns_, empty when the table is not indexed
+    std::vector<uint32_t> nonZeroColumns_;
+
+    void materialize(); // copies mapped columns into the vectors of the table
+    void refreshViews();
+
+    static float parseNumeric(std::string_view cell); // throws std::invalid_argument for a malformed cell
+    static std::vector<Category> remap(const Dictionary& from, Dictionary& to);
+};
+
+#endif //DECISIONTREE_DATATABLE_HPP
@@ -7,8 +7,11 @@
 #ifndef DECISIONTREE_DATASET_HPP
 #define DECISIONTREE_DATASET_HPP
 
+#include <memory>
 #include <string>
 
+class Profiler;
+
 /**
  * Holds the path of file containing data that is used during the train phase.
  */
@@ -32,6 +35,8 @@ struct Dataset {
   Train train;
   Test test;
   std::string classLabel;
+  bool useCache = false; //read each file from a binary cache next to it, which is (re)built when missing or stale
+  std::shared_ptr<Profiler> profiler; //when set, the time spent parsing each file is recorded in it, see Profiler
 };
 
 #endif //DECISIONTREE_DATASET_HPP
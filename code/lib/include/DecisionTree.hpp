@@ -9,29 +9,75 @@
 
 #include "Calculations.hpp"
 #include "DataReader.hpp"
+#include "FlatTree.hpp"
+#include "NodeArena.hpp"
 #include "Node.hpp"
+#include "TreeOptions.hpp"
 #include "TreeTest.hpp"
 #include "Utils.hpp"
 
 class DecisionTree {
   public:
     DecisionTree() = delete;
-    explicit DecisionTree(DataReader* dr);
-    explicit DecisionTree(DataReader* dr, const std::vector<size_t>& samples);
+    explicit DecisionTree(DataReader* dr, const TreeOptions& options = TreeOptions());
+    explicit DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const TreeOptions& options = TreeOptions());
+    explicit DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const Weights& weights, const TreeOptions& options = TreeOptions()); //distinct rows of a weighted sample, e.g. a bootstrap
+    explicit DecisionTree(DataReader* dr, SortedIndexes sorted, const Weights& weights, const TreeOptions& options = TreeOptions()); //rows of the sample, already presorted
+    explicit DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const Weights& weights, const Binning& binning, const TreeOptions& options = TreeOptions()); //quantization shared by the trees of a bag
+    DecisionTree(FlatTree flat, std::shared_ptr<const MetaData> schema, const TreeOptions& options = TreeOptions()); //restored model, inference only
+
+    static DecisionTree trainOutOfCore(const std::string& filename, const std::string& classLabel, const TreeOptions& options = TreeOptions()); //streams the file, see OutOfCore
+
+    void save(const std::string& filename) const;
+    static DecisionTree load(const std::string& filename, const TreeOptions& options = TreeOptions());
+    void generateCode(const std::string& filename) const; //standalone C++ source, see CodeGenerator
+    MetaData schema() const; //columns and dictionaries the tree was trained with, see DataTable::schema
 
     void print() const;
     void test() const;
 
-    inline Data testData() { return dr_->testData(); }
-    inline std::shared_ptr<Node> root() { return std::make_shared<Node>(root_); }
+    //cost-complexity pruning, see CostComplexity; only for trained trees
+    std::vector<double> pruningPath() const;
+    void prune(double alpha);
+    double prune(const DataTable& data, IndexRange rows); //alpha chosen on held-out rows, returns it
+    double prune(const DataTable& data); //all rows of data are held out
+
+    //batched inference into caller-provided buffers, large batches are spread over options.threads threads
+    void predict(const DataTable& data, size_t begin, size_t end, Category* out) const;
+    void predict(const DataTable& data, Category* out) const;
+    void predictProba(const DataTable& data, size_t begin, size_t end, float* out) const; //numClasses() floats per row
+    void predictProba(const DataTable& data, float* out) const;
+    inline size_t numClasses() const { return flat_.numClasses(); }
+
+    inline const DataTable& testData() const { return dr_->testData(); }
+    inline std::shared_ptr<Node> root() const { return arena_.toNode(root_); } //linked copy, built on every call
+    inline const FlatTree& flat() const { return flat_; } //compiled copy of the tree used for inference
 
-    Node root_;
   private:
+    NodeArena arena_; //all nodes of the tree, empty for restored models
+    uint32_t root_;
     DataReader* dr_; //changed to pointer to reduce memory overhead
+    TreeOptions options_;
+    ThreadPool* pool_; //only set while training
+    mutable std::shared_ptr<ThreadPool> predictionPool_; //kept for batch predictions: the pool of the options or of training, or created by the first large batch
+    std::vector<size_t> columns_; //every column of the training data
+    size_t features_; //columns evaluated per node, see TreeOptions::maxFeatures
+    double rootSize_; //rows of the root, counted with their weights
+    FlatTree flat_;
+    std::shared_ptr<const MetaData> schema_; //only set for restored models, which have no data reader
 
-    const Node buildTree(const Data& rows, const MetaData &meta, const std::vector<size_t>& indexes);
-    void print(const std::shared_ptr<Node> root, std::string spacing="") const;
-    const std::vector<size_t> createIndexes(const Data& data);
+    void train(std::vector<size_t> samples, const int* weights);
+    template <typename Rows>
+    void train(Rows root);
+    template <typename Rows>
+    std::tuple<double, Question> findSplit(const DataTable& rows, const Rows& node, const std::vector<int>& counts, uint64_t path, size_t depth, ThreadPool* pool) const;
+    template <typename Rows>
+    uint32_t buildTree(const DataTable& rows, Rows node, uint64_t path, size_t depth);
+    template <typename Rows>
+    uint32_t buildBestFirst(const DataTable& rows, Rows root);
+    const std::vector<size_t> drawColumns(uint64_t path) const;
+    void print(uint32_t index, std::string spacing="") const;
+    const std::vector<size_t> createIndexes(const DataTable& data);
 
 };
 
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_FLATTREE_HPP
+#define DECISIONTREE_FLATTREE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "DataTable.hpp"
+#include "NodeArena.hpp"
+
+class MappedFile;
+
+/**
+ * One node of a flattened tree, 16 bytes.
+ *
+ * The nodes are stored in depth-first order: the true child of a node directly
+ * follows it, the false child is at falseChild. A leaf has feature -1 and uses
+ * falseChild as the index of its prediction.
+ */
+struct FlatNode {
+  int32_t feature;
+  uint32_t falseChild;
+  union {
+    float threshold; // numeric question: example >= threshold
+    uint32_t categories; // categorical question: example in the set that starts at this index of the category words
+  };
+  uint32_t numeric;
+};
+
+/**
+ * Compiled representation of a trained tree, used for inference.
+ *
+ * All nodes live in one contiguous array with integer child offsets and
+ * pre-parsed thresholds, and every leaf stores its majority class and class
+ * probabilities, so classifying a row neither follows shared pointers nor
+ * copies class counters. The category sets of categorical questions are
+ * bitsets in one array of 32-bit words: the number of words of the set,
+ * followed by the words, bit c standing for category id c. The arrays are owned by the tree, or live in a mapped
+ * model file when the tree was loaded with ModelFile.
+ */
+class FlatTree {
+  public:
+    FlatTree();
+    FlatTree(const NodeArena& arena, uint32_t root);
+    FlatTree(const FlatTree& other);
+    FlatTree(FlatTree&& other) = default;
+    FlatTree& operator=(const FlatTree& other);
+    FlatTree& operator=(FlatTree&& other) = default;
+
+    inline size_t leaf(const DataTable& data, size_t row) const {
+      const FlatNode* node = nodesView_;
+      while (node->feature >= 0) {
+        const bool answer = node->numeric
+            ? data.numeric(node->feature)[row] >= node->threshold
+            : contains(node->categories, data.categories(node->feature)[row]);
+        node = answer ? node + 1 : nodesView_ + node->falseChild;
+      }
+      return node->falseChild;
+    }
+
+    inline Category predict(const DataTable& data, size_t row) const { return classesView_[leaf(data, row)]; }
+    inline const float* probabilities(const DataTable& data, size_t row) const {
+      return probabilitiesView_ + leaf(data, row) * numClasses_;
+    }
+
+    void predict(const DataTable& data, size_t begin, size_t end, Category* out) const;
+    void predictProba(const DataTable& data, size_t begin, size_t end, float* out) const;
+
+    inline const FlatNode* nodes() const { return nodesView_; }
+    inline const uint32_t* categoryWords() const { return categoriesView_; }
+    inline size_t categoryWordCount() const { return categoryWords_; }
+    inline bool contains(uint32_t set, Category category) const {
+      const uint32_t* words = categoriesView_ + set;
+      return category / 32 < words[0] && (words[1 + category / 32] >> (category % 32)) & 1;
+    }
+    inline const Category* leafClasses() const { return classesView_; }
+    inline const float* leafProbabilities() const { return probabilitiesView_; }
+    inline Category leafClass(size_t leaf) const { return classesView_[leaf]; }
+    inline size_t size() const { return size_; }
+    inline size_t leaves() const { return leaves_; }
+    inline size_t numClasses() const { return numClasses_; }
+
+  private:
+    friend class ModelFile;
+
+    std::vector<FlatNode> nodes_;
+    std::vector<Category> classes_; // majority class of every leaf
+    std::vector<float> probabilities_; // numClasses_ probabilities per leaf
+    std::vector<uint32_t> categories_; // category sets of the categorical questions
+    size_t numClasses_;
+
+    std::shared_ptr<const MappedFile> mapping_; // set when the arrays live in a mapped model file
+    const FlatNode* nodesView_;
+    const Category* classesView_;
+    const float* probabilitiesView_;
+    const uint32_t* categoriesView_;
+    size_t size_;
+    size_t leaves_;
+    size_t categoryWords_;
+
+    void add(const NodeArena& arena, uint32_t index);
+    void refreshViews();
+
+    static constexpr size_t blockSize = 64; // rows that descend the tree together
+
+    /**
+     * Method that traverses the rows in blocks: every pass advances all rows of
+     * the block by one level, so the nodes near the root stay in cache and the
+     * column reads of consecutive rows are adjacent.
+     *
+     * @param begin, end - rows to classify
+     * @param visit - called with (row, leaf index) for every row
+     */
+    template <typename F>
+    void traverse(const DataTable& data, size_t begin, size_t end, F visit) const {
+      uint32_t position[blockSize];
+      for (size_t block = begin; block < end; block += blockSize) {
+        const size_t n = std::min(blockSize, end - block);
+        std::fill(position, position + n, 0);
+
+        for (bool active = true; active; ) {
+          active = false;
+          for (size_t i = 0; i < n; i++) {
+            const FlatNode& node = nodesView_[position[i]];
+            if (node.feature < 0)
+              continue;
+            active = true;
+            const bool answer = node.numeric
+                ? data.numeric(node.feature)[block + i] >= node.threshold
+                : contains(node.categories, data.categories(node.feature)[block + i]);
+            position[i] = answer ? position[i] + 1 : node.falseChild;
+          }
+        }
+
+        for (size_t i = 0; i < n; i++)
+          visit(block + i, nodesView_[position[i]].falseChild);
+      }
+    }
+};
+
+#endif //DECISIONTREE_FLATTREE_HPP
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_FOREST_HPP
+#define DECISIONTREE_FOREST_HPP
+
+#include <cstdint>
+#include <vector>
+#include "DataTable.hpp"
+#include "FlatTree.hpp"
+
+/**
+ * Ensemble inference engine in the style of QuickScorer.
+ *
+ * Instead of walking every tree from the root, a row is scored feature by
+ * feature. The leaves of each tree are numbered left (true) to right (false)
+ * and every tree keeps a bitvector of the leaves that can still be reached.
+ * When the test of a node is false, the leaves of its true subtree become
+ * unreachable and are cleared. After all features, the first remaining leaf of
+ * a tree is its exit leaf. The numeric conditions of a feature are sorted by
+ * threshold, so only the false ones are visited; the votes go into a fixed
+ * array with one counter per class.
+ *
+ * As in RapidScorer, the bitvector of a tree spans as many machine words as it
+ * needs, ceil(leaves / 64), and a false condition clears the range of leaves
+ * of its true subtree, which mostly lies in one word. The cost per row grows
+ * with the number of nodes instead of the depth, so only trees with more than
+ * maxLeaves leaves are traversed as flat trees, a block of rows at a time.
+ */
+class Forest {
+  public:
+    Forest();
+    Forest(const std::vector<const FlatTree*>& trees, size_t numClasses);
+
+    void predict(const DataTable& data, size_t begin, size_t end, Category* out) const;
+    void votes(const DataTable& data, size_t row, int* votes) const; //numClasses() counters, one vote per tree
+
+    static constexpr size_t maxLeaves = 64 * 64; // larger trees are traversed instead
+
+    inline size_t trees() const { return leafOffsets_.size() + deep_.size(); }
+    inline size_t numClasses() const { return numClasses_; }
+
+  private:
+    struct Condition {
+      float threshold; //numeric: false when example < threshold
+      uint32_t categories; //categorical: false when example is not in the set at this index of categories_
+      uint32_t begin; //leaves [begin, end) of the true subtree, as bits of the concatenated bitvectors
+      uint32_t end;
+    };
+
+    std::vector<Condition> conditions_; //grouped by column, numeric groups by decreasing threshold
+    std::vector<size_t> columnOffsets_; //conditions of column c are [columnOffsets_[c], columnOffsets_[c + 1])
+    std::vector<size_t> leafOffsets_; //first leaf of every bitvector tree in leafClasses_
+    std::vector<size_t> wordOffsets_; //words of bitvector tree t are [wordOffsets_[t], wordOffsets_[t + 1])
+    std::vector<Category> leafClasses_;
+    std::vector<uint32_t> categories_; //category sets of the conditions, in the layout of FlatTree
+    std::vector<FlatTree> deep_; //trees with more than maxLeaves leaves
+    size_t numClasses_;
+
+    uint32_t collect(const FlatTree& tree, uint32_t node, uint32_t& leaf, std::vector<std::vector<Condition>>& columns);
+    static void clear(uint64_t* leaves, uint32_t begin, uint32_t end);
+    void addVotes(const DataTable& data, size_t row, uint64_t* leaves, int* votes) const; //votes of the bitvector trees
+};
+
+#endif //DECISIONTREE_FOREST_HPP
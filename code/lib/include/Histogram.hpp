@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_HISTOGRAM_HPP
+#define DECISIONTREE_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <vector>
+#include "DataTable.hpp"
+#include "IndexRange.hpp"
+#include "Question.hpp"
+
+/**
+ * Quantization of the features of a data set into a small number of bins.
+ *
+ * Every NUMERIC column is cut into at most maxBins bins: bin k holds the values
+ * in [cut(k), cut(k+1)), so "value >= cut(k)" is equivalent to "bin >= k".
+ * Columns with few distinct values get one bin per value, which makes the
+ * histogram splits identical to the exact ones. CATEGORICAL columns use their
+ * category ids as bins.
+ */
+class Binning {
+  public:
+    static constexpr size_t maxBins = 256;
+
+    Binning();
+    explicit Binning(const DataTable& data);
+    Binning(const Binning& cuts, const DataTable& data); // quantizes other rows with the bins of an existing binning
+
+    inline size_t columns() const { return codes_.size(); }
+    inline size_t bins(size_t column) const { return offsets_[column+1] - offsets_[column]; }
+    inline size_t offset(size_t column) const { return offsets_[column]; }
+    inline size_t totalBins() const { return offsets_.empty() ? 0 : offsets_.back(); }
+    inline const uint8_t* codes(size_t column) const { return codes_[column].data(); } // only for numeric columns
+
+    const Question question(size_t column, size_t bin) const; // numeric columns, sends the bins >= bin to the true branch
+    size_t bin(size_t column, float value) const; // numeric columns, the bin a value falls in
+
+  private:
+    std::vector<size_t> offsets_; // first bin of every column in a histogram, and the total at the back
+    std::vector<std::vector<uint8_t>> codes_; // bin of every row, empty for categorical columns
+    std::vector<std::vector<float>> cuts_; // lower edge of bins 1..n, empty for categorical columns
+};
+
+/**
+ * Class counts of the rows of a node, per bin of every column. For a sparse
+ * table the numeric columns are filled from the non-zero values only, see add.
+ * The counts are 64-bit, as a node trained out of core can hold more rows than
+ * an int counts.
+ */
+class Histogram {
+  public:
+    Histogram();
+    Histogram(const Binning& binning, size_t numClasses);
+
+    void add(const DataTable& data, const Binning& binning, IndexRange indexes, const int* weights = nullptr); // without weights every row counts once
+    void subtract(const Histogram& other); // used to derive a histogram from its parent and sibling
+
+    inline size_t numClasses() const { return numClasses_; }
+    inline const int64_t* counts(size_t bin) const { return counts_.data() + bin * numClasses_; }
+
+  private:
+    size_t numClasses_;
+    std::vector<int64_t> counts_;
+};
+
+#endif //DECISIONTREE_HISTOGRAM_HPP
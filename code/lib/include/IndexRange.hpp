@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_INDEXRANGE_HPP
+#define DECISIONTREE_INDEXRANGE_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Read-only view of a [begin, end) range of row indexes, e.g. the rows of a
+ * node in the index buffer of its tree. A vector converts to a view of all of
+ * its indexes.
+ */
+class IndexRange {
+  public:
+    IndexRange(const size_t* begin, const size_t* end) : begin_(begin), end_(end) {}
+    IndexRange(const std::vector<size_t>& indexes) : begin_(indexes.data()), end_(indexes.data() + indexes.size()) {}
+
+    inline const size_t* begin() const { return begin_; }
+    inline const size_t* end() const { return end_; }
+    inline size_t size() const { return end_ - begin_; }
+    inline bool empty() const { return begin_ == end_; }
+    inline size_t operator[](size_t i) const { return begin_[i]; }
+
+  private:
+    const size_t* begin_;
+    const size_t* end_;
+};
+
+#endif //DECISIONTREE_INDEXRANGE_HPP
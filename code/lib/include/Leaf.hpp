@@ -10,10 +10,10 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "DataTable.hpp"
 
 // You can change these data types
-using Data = std::vector<std::vector<std::string>>;
-using ClassCounter = std::unordered_map<std::string, int>;
+using ClassCounter = std::unordered_map<Category, int>;
 
 
 /**
@@ -27,7 +27,7 @@ using ClassCounter = std::unordered_map<std::string, int>;
 class Leaf {
   public:
     Leaf() = delete;
-    explicit Leaf(const ClassCounter cc);
+    explicit Leaf(ClassCounter cc);
     virtual ~Leaf() = default;
 
     inline const ClassCounter predictions() const { return predictions_; }
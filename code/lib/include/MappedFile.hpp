@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_MAPPEDFILE_HPP
+#define DECISIONTREE_MAPPEDFILE_HPP
+
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only memory mapping of a whole file, unmapped on destruction.
+ *
+ * A file that can not be opened maps to an empty view, so callers can treat
+ * it like an empty file.
+ */
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool isOpen() const { return open_; }
+    inline const char* data() const { return data_; }
+    inline size_t size() const { return size_; }
+    inline std::string_view view() const { return std::string_view(data_, size_); }
+
+  private:
+    const char* data_;
+    size_t size_;
+    bool open_;
+};
+
+#endif //DECISIONTREE_MAPPEDFILE_HPP
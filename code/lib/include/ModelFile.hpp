@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_MODELFILE_HPP
+#define DECISIONTREE_MODELFILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FlatTree.hpp"
+#include "Utils.hpp"
+
+/**
+ * Binary file format of trained models: one tree or the trees of a bag.
+ *
+ * A model file stores the schema of the training data (labels, types and the
+ * category dictionaries, see DataTable::schema) followed by the flat trees.
+ * Everything is little-endian and every array is 8-byte aligned, so on
+ * little-endian machines the loaded trees point straight into the mapped file;
+ * other machines convert the arrays while loading. The file does not depend on
+ * the size of the training data, only on the size of the trees.
+ *
+ * Layout: magic, version, schema, number of classes and trees, then per tree
+ * its node, leaf and category-word counts followed by the node, leaf-class,
+ * leaf-probability and category-word arrays. Version 2 replaced the single
+ * category of categorical questions by category sets.
+ */
+class ModelFile {
+  public:
+    static constexpr uint32_t version = 2;
+
+    static void save(const std::string& filename, const MetaData& schema, const std::vector<const FlatTree*>& trees);
+    static std::vector<FlatTree> load(const std::string& filename, MetaData& schema);
+};
+
+#endif //DECISIONTREE_MODELFILE_HPP
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_NODEARENA_HPP
+#define DECISIONTREE_NODEARENA_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Node.hpp"
+#include "Question.hpp"
+
+/**
+ * Node of a tree stored in a NodeArena. Internal nodes link to their children
+ * by index, leaves point at their class counts.
+ */
+struct ArenaNode {
+  Question question;
+  uint32_t trueChild;
+  uint32_t falseChild;
+  int32_t leaf; // index of the class counts of a leaf, -1 for internal nodes
+};
+
+/**
+ * Storage of all nodes of one tree.
+ *
+ * Nodes are added once, children before their parent, and never copied or
+ * moved afterwards: the tree is built bottom-up as indexes into two vectors,
+ * which are freed at once with the arena. Adding nodes is thread-safe, so the
+ * subtrees of a tree can be built concurrently.
+ */
+class NodeArena {
+  public:
+    NodeArena();
+    explicit NodeArena(size_t numClasses);
+    NodeArena(const NodeArena& other);
+    NodeArena(NodeArena&& other) noexcept;
+    NodeArena& operator=(const NodeArena& other);
+    NodeArena& operator=(NodeArena&& other) noexcept;
+
+    uint32_t addLeaf(const std::vector<int>& counts);
+    uint32_t addSplit(const Question& question, uint32_t trueChild, uint32_t falseChild);
+
+    inline const ArenaNode& node(uint32_t index) const { return nodes_[index]; }
+    inline const int* counts(const ArenaNode& leaf) const { return counts_.data() + leaf.leaf * numClasses_; }
+    inline size_t size() const { return nodes_.size(); }
+    inline size_t numClasses() const { return numClasses_; }
+
+    std::shared_ptr<Node> toNode(uint32_t index) const; // linked copy of a subtree, for code that walks Node graphs
+
+  private:
+    std::vector<ArenaNode> nodes_;
+    std::vector<int> counts_; // numClasses_ counts per leaf
+    size_t numClasses_;
+    std::mutex mutex_;
+};
+
+#endif //DECISIONTREE_NODEARENA_HPP
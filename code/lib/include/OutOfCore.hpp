@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_OUTOFCORE_HPP
+#define DECISIONTREE_OUTOFCORE_HPP
+
+#include <string>
+#include "NodeArena.hpp"
+#include "TreeOptions.hpp"
+#include "Utils.hpp"
+
+/**
+ * Training of a tree on an ARFF file that does not fit in memory.
+ *
+ * The file is streamed in blocks, several times:
+ *  1. a scan collects the category dictionaries, counts the rows and keeps
+ *     an evenly spread sample of them, from which the bins are computed;
+ *  2. every following pass routes each row one level down the splits found
+ *     so far and adds it to the class histogram of its open node. After the
+ *     pass, the open nodes are split on their histograms or become leaves.
+ *
+ * The node of every row is kept in a vector of 32-bit ids, on disk when it
+ * does not fit in the memory budget. When the histograms of all open nodes of
+ * a level do not fit either, the level takes several passes.
+ *
+ * The pre-pruning limits of the options apply, except maxLeafNodes; every node
+ * evaluates all of its columns.
+ */
+namespace OutOfCore {
+  struct Result {
+    NodeArena tree;
+    uint32_t root; // index of the root in tree
+    MetaData schema; // see DataTable::schema
+    size_t numClasses;
+    size_t passes;
+  };
+
+  Result train(const std::string& filename, const std::string& classLabel, const TreeOptions& options);
+}
+
+#endif //DECISIONTREE_OUTOFCORE_HPP
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_PROFILER_HPP
+#define DECISIONTREE_PROFILER_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Opt-in record of where training and inference spend their time. Set one in
+ * TreeOptions::profiler or Dataset::profiler (several objects may share it)
+ * and read it back with phases(), depths() and spans(), or export it as JSON
+ * or as a Chrome trace (chrome://tracing, Perfetto). Without a profiler
+ * nothing is measured and nothing is printed.
+ *
+ * Phases are totals of the time spent in one kind of work, summed over
+ * threads, so they can exceed the wall time. The phases of the library are:
+ *   parse           - reading a file (items: rows)
+ *   cache write failed - a data cache that could not be written, the file is parsed again next time (no time)
+ *   sort            - presorting the columns or quantizing them into bins (items: rows)
+ *   class counts    - counting the classes of a node (items: rows)
+ *   threshold scan  - searching the best split of a node, for the exact splitter including sorting its rows (items: rows)
+ *   partition       - dividing the rows of a node between its children (items: rows)
+ *   node allocation - adding a node to the arena of the tree
+ *   tree            - training one tree (items: rows)
+ *   bootstrap       - drawing the sample of a tree of a bag (items: rows)
+ *   out-of-bag      - the votes of a tree of a bag for its out-of-bag rows (items: rows)
+ *   predict         - batch prediction (items: rows)
+ *   pass            - one pass over the file of out-of-core training (items: rows)
+ * Per depth, the nodes and their weighted rows are counted (over all trees
+ * that share the profiler). Spans keep the start and duration of the coarse
+ * phases (parse, sort, tree, bag, pass) for the trace.
+ *
+ * All methods are thread-safe.
+ */
+class Profiler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+      std::string name;
+      size_t calls;
+      double seconds;
+      size_t items;
+    };
+
+    struct Depth {
+      size_t nodes;
+      double rows; // counted with their weights, e.g. the draws of a bootstrap
+    };
+
+    struct Span {
+      std::string name;
+      double start; // seconds since the profiler was created
+      double duration; // seconds
+      size_t thread; // 0 for the first thread that recorded a span, 1 for the next, ...
+    };
+
+    /**
+     * Measures the time of a phase from construction to destruction, and does
+     * nothing without a profiler.
+     */
+    class Scope {
+      public:
+        Scope(Profiler* profiler, const char* phase, size_t items = 0, bool span = false) :
+            profiler_(profiler), phase_(phase), items_(items), span_(span), start_() {
+          if (profiler_)
+            start_ = Clock::now();
+        }
+        ~Scope() {
+          if (profiler_)
+            profiler_->record(phase_, start_, Clock::now(), items_, span_);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        inline void setItems(size_t items) { items_ = items; } // when they are only known at the end
+
+      private:
+        Profiler* profiler_;
+        const char* phase_;
+        size_t items_;
+        bool span_;
+        Clock::time_point start_;
+    };
+
+    Profiler();
+
+    /**
+     * Method that measures one call of function as a phase, see Scope.
+     *
+     * @return - the result of the call
+     */
+    template <typename Function>
+    static auto measure(Profiler* profiler, const char* phase, size_t items, Function&& function) {
+      Scope scope(profiler, phase, items);
+      return function();
+    }
+
+    void record(const std::string& phase, Clock::time_point start, Clock::time_point end, size_t items = 0, bool span = false);
+    void node(size_t depth, double rows);
+    void clear();
+
+    std::vector<Phase> phases() const; // in the order they were first recorded
+    Phase phase(const std::string& name) const; // zeros when it was never recorded
+    std::vector<Depth> depths() const; // indexed by depth, the root has depth 0
+    std::vector<Span> spans() const;
+
+    std::string json() const; // {"phases": [...], "depths": [...], "spans": [...]}
+    std::string chromeTrace() const; // trace event format, the phases and depths as metadata
+    void writeJson(const std::string& filename) const;
+    void writeChromeTrace(const std::string& filename) const;
+
+  private:
+    mutable std::mutex mutex_;
+    Clock::time_point origin_;
+    std::vector<Phase> phases_;
+    std::vector<Depth> depths_;
+    std::vector<Span> spans_;
+    std::map<std::thread::id, size_t> threads_;
+};
+
+#endif //DECISIONTREE_PROFILER_HPP
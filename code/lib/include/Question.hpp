@@ -7,10 +7,10 @@
 #ifndef DECISIONTREE_QUESTION_HPP
 #define DECISIONTREE_QUESTION_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
-
-using VecS = std::vector<std::string>;
+#include "DataTable.hpp"
 
 /**
  * Representation of a "test" on an attritbute.
@@ -20,15 +20,26 @@ using VecS = std::vector<std::string>;
 class Question {
   public:
     Question();
-    Question(const int column, const std::string value);
+    Question(const int column, const float threshold);
+    Question(const int column, const Category category); //the set of one category
+    Question(const int column, std::vector<uint64_t> categories);
 
-    const bool solve(VecS example) const;
-    const bool isNumeric(std::string value) const;
+    inline const bool solve(const DataTable& data, size_t row) const {
+      if (numeric_)
+        return data.numeric(column_)[row] >= threshold_;
+      return contains(data.categories(column_)[row]);
+    }
+    inline bool contains(Category category) const {
+      const size_t word = category / 64;
+      return word < categories_.size() && (categories_[word] >> (category % 64)) & 1;
+    }
     const bool isNumeric(void) const;
-    const std::string toString(const VecS& labels) const;
+    const std::string toString(const VecS& labels, const DataTable& data) const;
 
     int column_;
-    std::string value_;
+    bool numeric_;
+    float threshold_; //used by numeric questions: example >= threshold
+    std::vector<uint64_t> categories_; //used by categorical questions: example in set, bit c of the bitset is category id c
 };
 
 #endif //DECISIONTREE_QUESTION_HPP
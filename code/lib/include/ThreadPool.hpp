@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_THREADPOOL_HPP
+#define DECISIONTREE_THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a queue: it pushes and pops its own tasks at the back
+ * (depth first) and steals from the front of the other queues when it runs
+ * out of work. Threads outside the pool share one extra queue. A thread that
+ * waits for a task keeps running pending tasks in the meantime, so recursive
+ * tasks can wait for their children without blocking a worker.
+ *
+ * Every task belongs to the group of the task that submitted it (a task
+ * submitted from outside the pool starts a group) and is one level deeper.
+ * A task that waits only helps with deeper tasks of its own group, e.g. the
+ * subtrees of its own tree, never with a large unrelated task, and sleeps
+ * until a task is pushed or finishes when there is none. Its own children are
+ * always among the tasks it can run, so waiting can't deadlock.
+ */
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threads = 0); // total number of threads including the caller, 0 means one per core
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+      using Result = decltype(task());
+      auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+      std::future<Result> future = packaged->get_future();
+      push([packaged]() { (*packaged)(); });
+      return future;
+    }
+
+    template <typename T>
+    T wait(std::future<T>& future) {
+      while (true) {
+        const size_t seen = events();
+        if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+          return future.get();
+        if (!runPendingTask(true))
+          sleepUntilEvent(seen);
+      }
+    }
+
+    /**
+     * Method that splits [begin, end) into chunks of at most grain items, runs
+     * them on the pool and returns when all of them are done.
+     *
+     * @param task - called as task(chunkBegin, chunkEnd)
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F task) {
+      std::vector<std::future<void>> chunks;
+      for (size_t chunk = begin; chunk < end; chunk += grain) {
+        const size_t chunkEnd = std::min(end, chunk + grain);
+        chunks.push_back(submit([&task, chunk, chunkEnd]() { task(chunk, chunkEnd); }));
+      }
+      for (auto& chunk: chunks)
+        wait(chunk);
+    }
+
+    inline size_t size() const { return workers_.size() + 1; }
+
+  private:
+    struct Task {
+      std::function<void()> run;
+      size_t group;
+      size_t depth;
+    };
+
+    struct Queue {
+      Queue() : mutex(), tasks({}) {}
+
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    void push(std::function<void()> task);
+    bool runPendingTask(bool waiting = false); // a waiting task only runs deeper tasks of its group
+    bool canHelp(const Task& task) const;
+    size_t events();
+    void sleepUntilEvent(size_t seen);
+    void work(size_t index);
+    size_t queueIndex() const; // queue of the calling thread
+
+    std::vector<std::unique_ptr<Queue>> queues_; // one per worker, the last one is shared by outside threads
+    std::vector<std::thread> workers_;
+    std::mutex sleepMutex_;
+    std::condition_variable wakeUp_;
+    std::condition_variable waiters_; // woken when a task is pushed or finishes
+    std::atomic<size_t> pending_;
+    std::atomic<size_t> groups_;
+    size_t events_; // tasks pushed or finished, guarded by sleepMutex_
+    bool stop_;
+};
+
+/**
+ * Method that runs task over [begin, end) in chunks of at most grain items on
+ * a temporary pool, or directly on the calling thread when the range fits in
+ * one chunk or only one thread is requested.
+ *
+ * @param threads - size of the pool, 0 means one thread per core
+ * @param task - called as task(chunkBegin, chunkEnd)
+ */
+template <typename F>
+void parallelFor(size_t threads, size_t begin, size_t end, size_t grain, F task) {
+  if (end - begin <= grain || threads == 1) {
+    task(begin, end);
+    return;
+  }
+  ThreadPool pool(threads);
+  pool.parallelFor(begin, end, grain, task);
+}
+
+/**
+ * Method like parallelFor above on a persistent pool, e.g. the one of a model
+ * that predicts many batches: the pool is only created by the first call that
+ * needs more than one thread and is kept for the next calls. When two threads
+ * create it at the same time, one of both pools is kept.
+ *
+ * @param pool - pool to run on, set on the first call when empty
+ * @param threads - size of the pool when it is created, 0 means one thread per core
+ * @param task - called as task(chunkBegin, chunkEnd)
+ */
+template <typename F>
+void parallelFor(std::shared_ptr<ThreadPool>& pool, size_t threads, size_t begin, size_t end, size_t grain, F task) {
+  if (end - begin <= grain || threads == 1) {
+    task(begin, end);
+    return;
+  }
+  std::shared_ptr<ThreadPool> current = std::atomic_load(&pool);
+  if (!current) {
+    std::shared_ptr<ThreadPool> created = std::make_shared<ThreadPool>(threads);
+    if (std::atomic_compare_exchange_strong(&pool, &current, created))
+      current = std::move(created);
+  }
+  current->parallelFor(begin, end, grain, task);
+}
+
+#endif //DECISIONTREE_THREADPOOL_HPP
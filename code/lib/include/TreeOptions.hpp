@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_TREEOPTIONS_HPP
+#define DECISIONTREE_TREEOPTIONS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class Profiler;
+class ThreadPool;
+
+/**
+ * Strategy used to search the best split of a node.
+ *
+ * Exact sorts the rows of every node on every column. Presorted sorts every
+ * column once and keeps the order stable while partitioning, so each node
+ * only needs a linear scan per column. Histogram quantizes every numeric
+ * column into at most 256 bins up front and scans per-node class histograms,
+ * so a column costs O(bins) instead of O(rows).
+ *
+ * On sparse training data (see DataTable::indexSparse) Exact only sorts the
+ * non-zero values of a node and Histogram only counts them, the rows with
+ * value 0 are derived from the class counts of the node. Presorted does not
+ * use the sparse index.
+ */
+enum class Splitter {
+  Exact,
+  Presorted,
+  Histogram
+};
+
+/**
+ * Number of columns every node draws at random and evaluates for its split
+ * (random subspace); the best split among them is kept. All evaluates every
+ * column, Count evaluates maxFeaturesValue columns, Fraction that share of the
+ * columns, Sqrt and Log2 the square root or the base-2 logarithm of the number
+ * of columns. A node always evaluates at least one column.
+ */
+enum class MaxFeatures {
+  All,
+  Count,
+  Fraction,
+  Sqrt,
+  Log2
+};
+
+/**
+ * Settings that control how a decision tree (or each tree of a bag) is trained.
+ */
+struct TreeOptions {
+  Splitter splitter = Splitter::Exact;
+  size_t threads = 0; // threads used to build the subtrees, 0 means one per core and 1 builds sequentially
+  size_t parallelCutoff = 2048; // nodes with fewer rows build their subtrees sequentially
+  bool parallelFeatures = false; // nodes with at least parallelCutoff rows also evaluate their columns in parallel
+  std::shared_ptr<ThreadPool> pool = nullptr; // when set, the tree trains and predicts on this pool instead of creating one
+  std::shared_ptr<Profiler> profiler = nullptr; // when set, training and prediction record their phases in it, see Profiler
+  size_t memoryBudget = size_t(1) << 30; // bytes that out-of-core training may use for blocks, histograms and row assignments
+  MaxFeatures maxFeatures = MaxFeatures::All;
+  double maxFeaturesValue = 1.0; // number of columns for MaxFeatures::Count, share of the columns for MaxFeatures::Fraction
+  uint64_t seed = 0; // seeds the columns drawn by every node; a bag gives each of its trees its own seed
+
+  //pre-pruning: a node becomes a leaf as soon as one of these limits is reached, rows are counted with their weights
+  size_t maxDepth = 0; // nodes at this depth (the root has depth 0) are leaves, 0 means unlimited
+  size_t minSamplesSplit = 2; // nodes with fewer rows are leaves
+  size_t minSamplesLeaf = 1; // splits that leave fewer rows in a branch are not considered
+  double minImpurityDecrease = 0.0; // splits whose gain times the share of the training rows in the node is lower are not made
+  size_t maxLeafNodes = 0; // the tree grows best first (highest weighted gain) until it has this many leaves, 0 means unlimited
+
+  /**
+   * Method that computes how many columns a node evaluates.
+   *
+   * @param columns - number of columns of the data set
+   * @return - number of columns drawn per node, between 1 and columns
+   */
+  inline size_t featuresPerSplit(size_t columns) const {
+    double features = columns;
+    switch (maxFeatures) {
+      case MaxFeatures::Count: features = maxFeaturesValue; break;
+      case MaxFeatures::Fraction: features = maxFeaturesValue * columns; break;
+      case MaxFeatures::Sqrt: features = std::sqrt(static_cast<double>(columns)); break;
+      case MaxFeatures::Log2: features = std::log2(static_cast<double>(columns)); break;
+      default: break;
+    }
+    return std::min(columns, static_cast<size_t>(std::max(1.0, features)));
+  }
+};
+
+constexpr size_t predictionGrain = 16384; // rows per task of a batch prediction
+
+#endif //DECISIONTREE_TREEOPTIONS_HPP
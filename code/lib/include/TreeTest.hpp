@@ -15,14 +15,16 @@ using ClassCounterScaled = std::unordered_map<std::string, std::string>;
 class TreeTest {
   public:
     TreeTest() = default;
-    TreeTest(const Data& testData, const MetaData& meta, const Node &root);
+    TreeTest(const DataTable& testData, const MetaData& meta, const Node &root);
+    TreeTest(const DataTable& testData, const std::vector<Category>& predictions);
     ~TreeTest() = default;
 
-    const ClassCounter classify(const VecS& row, std::shared_ptr<Node> node) const;
+    const ClassCounter classify(const DataTable& data, size_t row, std::shared_ptr<Node> node) const;
 
   private:
-    void printLeaf(ClassCounter counts) const;
-    void test(const Data& testing_data, const VecS& labels, std::shared_ptr<Node> tree) const;
+    void printLeaf(ClassCounter counts, const VecS& classNames) const;
+    void test(const DataTable& testing_data, const VecS& labels, std::shared_ptr<Node> tree) const;
+    void test(const DataTable& testData, const std::vector<Category>& predictions) const;
 };
 
 #endif //DECISIONTREE_TREETEST_HPP
@@ -16,44 +16,28 @@
 #include <unordered_map>
 #include <vector>
 #include <set>
-#include <boost/timer/timer.hpp>
 
 
 // You can change these data type aliases
 using VecS = std::vector<std::string>;
 using LabelMap = std::map<std::string, std::string>;
-using Data = std::vector<std::vector<std::string>>;
+using DomainMap = std::map<std::string, VecS>;
 struct MetaData {
-  VecS labels;
-  LabelMap labelMap; //used for checking whether the feature is Numeric or Categorical
+  VecS labels{};
+  LabelMap labelMap{}; //used for checking whether the feature is Numeric or Categorical
+  DomainMap domains{}; //values declared in the header for categorical features
 };
 
 /**
- * Custom comparator for numeric features
+ * Custom comparator that orders row indexes by the value of a typed column
  */
-struct NumericComparator{
-    explicit NumericComparator(int i, const Data& rows) : data(rows){
-        column = i;
+template <typename T>
+struct ColumnComparator{
+    explicit ColumnComparator(const T* column) : values(column) {}
+    const T* values;
+    bool operator() (const size_t row1, const size_t row2) const{
+        return values[row1] < values[row2];
     }
-    int column;
-    const Data& data;
-    bool operator() (const size_t vec1, const size_t vec2) const{
-        return std::stod(data[vec1][column]) < std::stod(data[vec2][column]);
-    }
-};
-
-/**
- * Custom comparator for categorical features
- */
-struct StringComparator{
-        explicit StringComparator(int i, const Data& rows) : data(rows){
-            column = i;
-        }
-        int column;
-        const Data& data;
-        bool operator() (const size_t vec1, const size_t vec2) const{
-            return data[vec1][column] < data[vec2][column];
-        }
 };
 
 namespace Utils::iterators {
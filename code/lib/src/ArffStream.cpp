@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <stdexcept>
+#include "ArffStream.hpp"
+#include "DataReader.hpp"
+
+ArffStream::ArffStream(const std::string& filename, const std::string& classLabel, size_t blockBytes) :
+    file_(filename, std::ios::binary),
+    meta_({}),
+    columns_({}),
+    dataStart_(0),
+    blockBytes_(std::max<size_t>(blockBytes, 1)),
+    buffer_(),
+    carry_() {
+  if (!file_)
+    throw std::runtime_error("Can't open file: " + filename);
+
+  std::string line;
+  bool header_loaded = false;
+  while (!header_loaded && getline(file_, line))
+    DataReader::parseHeaderLine(line, meta_, header_loaded);
+  if (!header_loaded)
+    throw std::runtime_error("No @DATA section in file: " + filename);
+
+  columns_ = DataReader::moveClassLabelToBack(meta_, classLabel);
+  dataStart_ = file_.tellg();
+}
+
+void ArffStream::rewind() {
+  file_.clear();
+  file_.seekg(dataStart_);
+  carry_.clear();
+}
+
+/**
+ * Method that parses the next block of whole lines.
+ *
+ * @param block - receives the rows of the block
+ * @param schema - meta data whose domains fix the category ids, see DataTable::schema
+ * @param pool - threads that parse the block
+ * @return - false when the end of the file was reached before any row
+ */
+bool ArffStream::next(DataTable& block, const MetaData& schema, ThreadPool& pool) {
+  block = DataTable(schema);
+  while (block.rows() == 0) {
+    if (!file_ && carry_.empty())
+      return false;
+
+    buffer_.swap(carry_);
+    carry_.clear();
+    const size_t start = buffer_.size();
+    buffer_.resize(start + blockBytes_);
+    file_.read(&buffer_[start], blockBytes_);
+    buffer_.resize(start + file_.gcount());
+
+    //the last partial line is kept for the next block, unless the file ends here
+    if (file_) {
+      const size_t end = buffer_.rfind('\n');
+      if (end == std::string::npos) {
+        carry_.swap(buffer_);
+        continue;
+      }
+      carry_.assign(buffer_, end + 1, std::string::npos);
+      buffer_.resize(end + 1);
+    }
+    DataReader::parseRows(buffer_, block, schema, columns_, pool);
+  }
+  return true;
+}
@@ -5,73 +5,272 @@
  */
 
 #include "Bagging.hpp"
+#include "CodeGenerator.hpp"
+#include "ModelFile.hpp"
+#include "Profiler.hpp"
 
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
-using boost::timer::cpu_timer;
 
-Bagging::Bagging(DataReader *dr, const int ensembleSize, uint seed) :
+Bagging::Bagging(DataReader *dr, const int ensembleSize, uint seed, const TreeOptions& options) :
   dr_(dr),
   ensembleSize_(ensembleSize),
-  learners_({}) {
-  random_number_generator.seed(seed);
+  options_(options),
+  pool_(options.pool),
+  learners_({}),
+  forest_(),
+  seed_(seed),
+  oobVotes_({}),
+  oobAccuracy_(0) {
   buildBag();
+  buildForest();
+}
+
+Bagging::Bagging(std::vector<DecisionTree> learners, const TreeOptions& options) :
+  dr_(nullptr),
+  ensembleSize_(learners.size()),
+  options_(options),
+  pool_(options.pool),
+  learners_(std::move(learners)),
+  forest_(),
+  seed_(0),
+  oobVotes_({}),
+  oobAccuracy_(0) {
+  buildForest();
 }
 
 
 void Bagging::buildBag() {
-  cpu_timer timer;
-  std::vector<double> timings;
-  for (int i = 0; i < ensembleSize_; i++) {
-    timer.start();
-
-    //sampling data and training a tree classifier with sampled data
-    std::vector<size_t> samples = sampleData(dr_->trainData().size());
-    const DecisionTree decisionTree(dr_, samples);
-    learners_.emplace_back(std::move(decisionTree));
-
-    auto nanoseconds = boost::chrono::nanoseconds(timer.elapsed().wall);
-    auto seconds = boost::chrono::duration_cast<boost::chrono::seconds>(nanoseconds);
-    timings.push_back(seconds.count());
+  Profiler* profiler = options_.profiler.get();
+  Profiler::Scope scope(profiler, "bag", ensembleSize_, true);
+
+  //the columns are sorted or quantized only once, each bootstrap derives its order from it
+  SortedIndexes sorted;
+  if (options_.splitter == Splitter::Presorted) {
+    Profiler::Scope sort(profiler, "sort", dr_->trainData().rows(), true);
+    std::vector<size_t> indexes(dr_->trainData().rows());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    sorted = Calculations::presort(dr_->trainData(), indexes);
+  }
+  Binning binning;
+  if (options_.splitter == Splitter::Histogram) {
+    Profiler::Scope sort(profiler, "sort", dr_->trainData().rows(), true);
+    binning = Binning(dr_->trainData());
   }
-  float avg_timing = Utils::iterators::average(std::begin(timings), std::begin(timings) + std::min(5, ensembleSize_));
-  std::cout << "Average timing: " << avg_timing << std::endl;
+
+  //the trees are trained concurrently on one pool, which they also use to build their subtrees
+  TreeOptions options = options_;
+  if (!options.pool)
+    options.pool = std::make_shared<ThreadPool>(options_.threads);
+  pool_ = options.pool;
+
+  const DataTable& data = dr_->trainData();
+  oobVotes_.assign(data.rows() * data.numClasses(), 0);
+  std::mutex oobMutex;
+
+  auto train = [this, &options, &sorted, &binning, &oobMutex, profiler](int tree) {
+    //sampling data and training a tree classifier on the distinct sampled rows, weighted by their draws
+    const size_t rows = dr_->trainData().rows();
+    const Weights weights = Profiler::measure(profiler, "bootstrap", rows, [&]() { return sampleData(rows, tree); });
+    std::vector<size_t> samples;
+    for (size_t row = 0; row < weights.size(); row++)
+      if (weights[row] > 0)
+        samples.push_back(row);
+
+    //with max features, every tree draws the columns of its nodes from a seed of its own, which makes the bag a random forest
+    TreeOptions treeOptions = options;
+    treeOptions.seed = (static_cast<uint64_t>(seed_) << 32) | static_cast<uint64_t>(tree);
+
+    auto build = [&]() {
+      if (options.splitter == Splitter::Presorted)
+        return DecisionTree(dr_, Calculations::sample(sorted, weights), weights, treeOptions);
+      if (options.splitter == Splitter::Histogram)
+        return DecisionTree(dr_, samples, weights, binning, treeOptions);
+      return DecisionTree(dr_, samples, weights, treeOptions);
+    };
+    DecisionTree learner = build();
+    voteOutOfBag(learner, weights, oobMutex);
+    return learner;
+  };
+
+  std::vector<std::future<DecisionTree>> trees;
+  for (int i = 0; i < ensembleSize_; i++)
+    trees.push_back(options.pool->submit([&train, i]() { return train(i); }));
+
+  //collecting in submission order keeps the ensemble independent of the scheduling
+  for (auto& tree: trees)
+    learners_.push_back(options.pool->wait(tree));
+
+  computeOobAccuracy();
 }
 
-void Bagging::test() const {
-  TreeTest t;
-  float accuracy = 0;
-  for (const auto& row: dr_->testData()) {
-    static size_t last = row.size() - 1;
-    std::vector<std::string> decisions;
-    for (int i = 0; i < ensembleSize_; i++) {
-      const std::shared_ptr<Node> root = std::make_shared<Node>(learners_.at(i).root_);
-      const auto& classification = t.classify(row, root);
-      decisions.push_back(Utils::tree::getMax(classification));
-    }
-    std::string prediction = Utils::iterators::mostCommon(decisions.begin(), decisions.end());
-    if (prediction == row[last])
-      accuracy += 1;
+/**
+ * Method that lets a tree vote for the training rows its bootstrap left out.
+ * It runs in the task that trained the tree, while the bootstrap is at hand;
+ * the votes are counts, so they don't depend on the order of the tasks.
+ *
+ * @param tree - trained tree
+ * @param weights - bootstrap of the tree, see sampleData
+ * @param mutex - guards oobVotes_ against the other tasks
+ */
+void Bagging::voteOutOfBag(const DecisionTree& tree, const Weights& weights, std::mutex& mutex) {
+  const DataTable& data = dr_->trainData();
+  const size_t numClasses = data.numClasses();
+  std::vector<Category> predictions;
+  Profiler::measure(options_.profiler.get(), "out-of-bag", weights.size(), [&]() {
+    for (size_t row = 0; row < weights.size(); row++)
+      if (weights[row] == 0)
+        predictions.push_back(tree.flat().predict(data, row));
+  });
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto prediction = predictions.begin();
+  for (size_t row = 0; row < weights.size(); row++)
+    if (weights[row] == 0)
+      oobVotes_[row * numClasses + *prediction++]++;
+}
+
+/**
+ * Method that computes the out-of-bag accuracy from the votes of the trees.
+ */
+void Bagging::computeOobAccuracy() {
+  const size_t numClasses = dr_->trainData().numClasses();
+  //the out-of-bag prediction of a row is the majority vote of the trees that did not draw it, ties go to the lowest class id
+  const Category* classes = dr_->trainData().classes();
+  size_t voted = 0, correct = 0;
+  for (size_t row = 0; row < dr_->trainData().rows(); row++) {
+    const int* votes = oobVotes_.data() + row * numClasses;
+    const size_t prediction = std::max_element(votes, votes + numClasses) - votes;
+    if (votes[prediction] == 0)
+      continue;
+    voted++;
+    correct += prediction == classes[row];
   }
-  std::cout << "Total accuracy: " << (accuracy / dr_->testData().size()) << std::endl;
+  oobAccuracy_ = voted > 0 ? static_cast<double>(correct) / voted : 0;
 }
 
 /**
- * Method that takes a sample of the original data. The data is randomly sampled.
+ * Method that prunes every tree with the alpha that classifies its out-of-bag
+ * rows best, see DecisionTree::prune. The out-of-bag votes are counted again
+ * for the pruned trees; as the same rows chose alpha, oobAccuracy() is then
+ * somewhat optimistic.
+ */
+void Bagging::prune() {
+  if (!dr_)
+    throw std::logic_error("A restored bag can only predict");
+  const DataTable& data = dr_->trainData();
+  oobVotes_.assign(data.rows() * data.numClasses(), 0);
+  std::mutex oobMutex;
+  parallelFor(pool_, options_.threads, 0, learners_.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t tree = begin; tree < end; tree++) {
+      const Weights weights = sampleData(data.rows(), tree);
+      std::vector<size_t> oob;
+      for (size_t row = 0; row < weights.size(); row++)
+        if (weights[row] == 0)
+          oob.push_back(row);
+      learners_[tree].prune(data, oob);
+      voteOutOfBag(learners_[tree], weights, oobMutex);
+    }
+  });
+  buildForest();
+  computeOobAccuracy();
+}
+
+void Bagging::buildForest() {
+  forest_ = Forest(flatTrees(), learners_.empty() ? 0 : learners_.front().numClasses());
+}
+
+std::vector<const FlatTree*> Bagging::flatTrees() const {
+  std::vector<const FlatTree*> trees;
+  for (const auto& learner: learners_)
+    trees.push_back(&learner.flat());
+  return trees;
+}
+
+/**
+ * Method that saves all trees of the bag to one model file, see ModelFile.
+ *
+ * @param filename - path of the model file
+ */
+void Bagging::save(const std::string& filename) const {
+  ModelFile::save(filename, learners_.empty() ? MetaData() : learners_.front().schema(), flatTrees());
+}
+
+/**
+ * Method that writes the bag as a standalone C++ source that predicts the
+ * majority vote of the trees, see CodeGenerator.
+ *
+ * @param filename - path of the source file
+ */
+void Bagging::generateCode(const std::string& filename) const {
+  CodeGenerator::generate(filename, flatTrees(), learners_.empty() ? MetaData() : learners_.front().schema());
+}
+
+/**
+ * Method that loads a bag saved with save(), without training data. The bag
+ * can only be used for prediction, see DecisionTree::load.
+ *
+ * @param filename - path of the model file
+ * @param options - options used for prediction (threads)
+ * @return - the restored bag
+ */
+Bagging Bagging::load(const std::string& filename, const TreeOptions& options) {
+  auto schema = std::make_shared<MetaData>();
+  std::vector<FlatTree> trees = ModelFile::load(filename, *schema);
+
+  std::vector<DecisionTree> learners;
+  for (auto& tree: trees)
+    learners.emplace_back(std::move(tree), schema, options);
+  return Bagging(std::move(learners), options);
+}
+
+void Bagging::test() const {
+  if (!dr_)
+    throw std::logic_error("A restored bag can only predict");
+  const DataTable& testData = dr_->testData();
+  std::vector<Category> predictions(testData.rows());
+  predict(testData, predictions.data());
+  TreeTest t(testData, predictions);
+}
+
+void Bagging::predict(const DataTable& data, size_t begin, size_t end, Category* out) const {
+  Profiler::Scope scope(options_.profiler.get(), "predict", end - begin);
+  parallelFor(pool_, options_.threads, begin, end, predictionGrain, [&](size_t chunk, size_t chunkEnd) {
+    forest_.predict(data, chunk, chunkEnd, out + (chunk - begin));
+  });
+}
+
+void Bagging::predict(const DataTable& data, Category* out) const {
+  predict(data, 0, data.rows(), out);
+}
+
+/**
+ * Method that takes a bootstrap sample of the original data: size rows drawn
+ * randomly with replacement, returned as the number of times every row was
+ * drawn. A tree is trained on the drawn rows only, each counted with its
+ * weight, which is equivalent to training on the duplicated rows. The rows with
+ * weight 0 are out of bag for the tree.
+ *
+ * Every tree draws from its own random number stream, seeded from the seed of
+ * the bag and the index of the tree, so the samples do not depend on the
+ * order or the thread in which the trees are trained.
  *
- * @param data - data that you want to sample
- * @return - vector of data indexes
+ * @param size - number of rows in the data that you want to sample
+ * @param tree - index of the tree the sample is for
+ * @return - weight of every row
  */
-const std::vector<size_t> Bagging::sampleData(int size) const {
+const Weights Bagging::sampleData(int size, int tree) const {
+    std::seed_seq sequence{static_cast<uint64_t>(seed_), static_cast<uint64_t>(tree)};
+    std::mt19937_64 random_number_generator(sequence);
     std::uniform_int_distribution<size_t> distribution(0, size-1);
-    std::vector<size_t> sampleData;
+    Weights weights(size, 0);
 
     for (int i = 0; i < size; i++){
-        sampleData.push_back(distribution(const_cast<std::mt19937_64&>(random_number_generator)));
+        weights[distribution(random_number_generator)] += 1;
     }
 
-    return sampleData;
+    return weights;
 }
 
 
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <stdexcept>
+#include "BinaryFile.hpp"
+
+namespace BinaryFile {
+
+void Writer::text(const std::string& value) {
+  this->value<uint64_t>(value.size());
+  bytes(value.data(), value.size());
+}
+
+void Writer::texts(const VecS& values) {
+  value<uint64_t>(values.size());
+  for (const auto& v: values)
+    text(v);
+}
+
+/**
+ * Method that writes the labels, their types and the declared domains.
+ */
+void Writer::meta(const MetaData& meta) {
+  texts(meta.labels);
+  for (const auto& label: meta.labels) {
+    const auto type = meta.labelMap.find(label);
+    text(type != std::end(meta.labelMap) ? type->second : "");
+    const auto domain = meta.domains.find(label);
+    value<uint8_t>(domain != std::end(meta.domains));
+    if (domain != std::end(meta.domains))
+      texts(domain->second);
+  }
+}
+
+void Writer::align() {
+  const char zeros[8] = {};
+  bytes(zeros, padding(offset_));
+}
+
+const char* Reader::bytes(size_t size) {
+  if (size > size_ - offset_)
+    throw std::runtime_error("Unexpected end of file");
+  const char* data = data_ + offset_;
+  offset_ += size;
+  return data;
+}
+
+std::string Reader::text() {
+  const auto size = value<uint64_t>();
+  return std::string(bytes(size), size);
+}
+
+VecS Reader::texts() {
+  //every string takes at least the 8 bytes of its length, so a count can be checked before allocating
+  const auto count = value<uint64_t>();
+  if (count > remaining() / 8)
+    throw std::runtime_error("Unexpected end of file");
+  VecS values(count);
+  for (auto& v: values)
+    v = text();
+  return values;
+}
+
+MetaData Reader::meta() {
+  MetaData meta;
+  meta.labels = texts();
+  for (const auto& label: meta.labels) {
+    meta.labelMap[label] = text();
+    if (value<uint8_t>())
+      meta.domains[label] = texts();
+  }
+  return meta;
+}
+
+void Reader::align() {
+  bytes(padding(offset_));
+}
+
+} // namespace BinaryFile
@@ -8,8 +8,14 @@
 #include <algorithm>
 #include <iterator>
 #include "Calculations.hpp"
+#include "ThreadPool.hpp"
 #include "Utils.hpp"
 #include <future>
+#include <limits>
+#include <numeric>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 using std::tuple;
 using std::pair;
@@ -18,135 +24,661 @@ using std::vector;
 using std::string;
 using std::unordered_map;
 
-tuple<const std::vector<size_t>, const std::vector<size_t>> Calculations::partition(const Data& data, const Question& q, const std::vector<size_t>& indexes) {
-  std::vector<size_t> true_indexes;
-  std::vector<size_t> false_indexes;
-  
-  for (const auto &index : indexes) {
-    auto row = data[index];
-    if (q.solve(row))
-      true_indexes.push_back(index);
-    else
-      false_indexes.push_back(index);
+namespace {
+
+inline int weight(const int* weights, size_t index) {
+  return weights ? weights[index] : 1;
+}
+
+/**
+ * Linear scan over the indexes (sorted on the values of the column) that
+ * returns the value at the best split position together with its weighted
+ * gini index.
+ *
+ * Instead of recomputing the gini index of both branches at every position,
+ * the sums of squared class counts are updated in O(1) per row: moving a row
+ * of class k and weight w from the right branch (count r) to the left branch
+ * (count l) adds 2lw+w^2 to the left sum and removes 2rw-w^2 from the right
+ * one. The weighted gini index is then 1 - (left_squares/left_size +
+ * right_squares/right_size)/N. The class counts live in a per-thread buffer,
+ * so the scan does not allocate.
+ */
+template <typename T>
+tuple<T, double> scan_threshold(const T* values, const Category* classes, IndexRange indexes, const int* weights, const std::vector<int>& counter, size_t minLeaf) {
+  T best_thresh{};
+  double best_score = -1;
+
+  thread_local std::vector<int> left_branch;
+  left_branch.assign(counter.size(), 0);
+  const int* right_branch = counter.data();
+
+  const int64_t N = std::accumulate(counter.begin(), counter.end(), int64_t(0));
+  int64_t left_size = 0;
+  int64_t left_squares = 0;
+  int64_t right_squares = std::llround(Calculations::sum_of_squares(counter.data(), counter.size()));
+
+  //going linear through whole dataset, trying to find the best threshold to split the dataset
+  for (size_t row = 1; row < indexes.size(); row++){
+      size_t index = indexes[row-1];
+      const Category current_class = classes[index];// getting the class
+      const int64_t w = weight(weights, index);
+
+      //updating the sums of squares as the row moves from the right to the left branch
+      const int64_t left = left_branch[current_class];
+      const int64_t right = right_branch[current_class] - left;
+      left_branch[current_class] += w;
+      left_squares += 2*left*w + w*w;
+      right_squares -= 2*right*w - w*w;
+      left_size += w;
+
+      //skipping over the updating the loss, until we find a datapoint of different value
+      size_t current_index = indexes[row];
+      if (values[index] == values[current_index]) continue;
+
+      //both branches need at least minLeaf rows
+      if (left_size < static_cast<int64_t>(minLeaf) || N - left_size < static_cast<int64_t>(minLeaf)) continue;
+
+      const double score = static_cast<double>(left_squares)/left_size + static_cast<double>(right_squares)/(N-left_size);
+      if (score > best_score){
+          best_score = score;
+          best_thresh = values[current_index];
+      }
+  }
+
+  if (best_score < 0)
+      return {best_thresh, std::numeric_limits<float>::infinity()};
+  return {best_thresh, (N - best_score)/N};
+}
+
+/**
+ * Linear scan like scan_threshold for a sparse table, which only visits the
+ * rows of the node whose value in the column is not 0. The rows with value 0
+ * are moved as one group between the negative and the positive values; their
+ * class counts are the counts of the node minus those of the visited rows.
+ * The result is the same as scanning all rows of the node.
+ *
+ * @param indexes - rows of the node with a non-zero value, sorted on the column
+ * @param zeros - number of rows of the node with value 0
+ */
+tuple<float, double> scan_sparse_threshold(const float* values, const Category* classes, IndexRange indexes, size_t zeros, const int* weights, const std::vector<int>& counter, size_t minLeaf) {
+  float best_thresh{};
+  double best_score = -1;
+
+  thread_local std::vector<int> left_branch;
+  thread_local std::vector<int> zero_branch;
+  left_branch.assign(counter.size(), 0);
+  zero_branch.assign(counter.begin(), counter.end());
+  for (const auto& index: indexes)
+      zero_branch[classes[index]] -= weight(weights, index);
+
+  const int64_t N = std::accumulate(counter.begin(), counter.end(), int64_t(0));
+  int64_t left_size = 0;
+  int64_t left_squares = 0;
+  int64_t right_squares = std::llround(Calculations::sum_of_squares(counter.data(), counter.size()));
+
+  auto move = [&](Category current_class, int64_t w) {
+      const int64_t left = left_branch[current_class];
+      const int64_t right = counter[current_class] - left;
+      left_branch[current_class] += w;
+      left_squares += 2*left*w + w*w;
+      right_squares -= 2*right*w - w*w;
+      left_size += w;
+  };
+
+  //evaluated before the rows of the next value move to the left branch
+  bool started = false;
+  float previous = 0;
+  auto next_value = [&](float value) {
+      if (!started || value == previous) return;
+      if (left_size < static_cast<int64_t>(minLeaf) || N - left_size < static_cast<int64_t>(minLeaf)) return;
+
+      const double score = static_cast<double>(left_squares)/left_size + static_cast<double>(right_squares)/(N-left_size);
+      if (score > best_score){
+          best_score = score;
+          best_thresh = value;
+      }
+  };
+  auto move_zeros = [&]() {
+      next_value(0);
+      for (size_t k = 0; k < zero_branch.size(); k++)
+          move(k, zero_branch[k]);
+      started = true;
+      previous = 0;
+      zeros = 0;
+  };
+
+  for (const auto& index: indexes) {
+      const float value = values[index];
+      if (zeros > 0 && value > 0)
+          move_zeros();
+      next_value(value);
+      move(classes[index], weight(weights, index));
+      started = true;
+      previous = value;
   }
+  if (zeros > 0)
+      move_zeros();
 
-  return forward_as_tuple(true_indexes, false_indexes);
+  if (best_score < 0)
+      return {best_thresh, std::numeric_limits<float>::infinity()};
+  return {best_thresh, (N - best_score)/N};
 }
 
-tuple<const double, const Question> Calculations::find_best_split(const Data& rows, const MetaData& meta, const std::vector<size_t>& indexes) {
+/**
+ * Method that finds the best set of categories to send to the true branch,
+ * given the class counts of every category in the node.
+ *
+ * The categories are ordered by the proportion of a class and only the
+ * prefixes of that order are evaluated, which costs O(C log C) instead of
+ * O(2^C) for C categories. For two classes the best prefix is the best subset
+ * (Breiman et al., 1984). With more classes this is a heuristic: every class
+ * gives an order and the best prefix of all of them is kept. Categories that
+ * do not occur in the node, or only later in the test data, go to the false
+ * branch.
+ *
+ * @param column - categorical column
+ * @param counts - K class counts per category id, of rows or of a histogram
+ * @param present - ids of the categories that occur in the node, increasing
+ * @param counter - class counts of the node
+ * @param minLeaf - minimum number of rows in each branch
+ * @return - question with the best set and its weighted gini index
+ */
+template <typename Count>
+tuple<const Question, double> best_subset(int column, const Count* counts, const std::vector<Category>& present, const std::vector<Count>& counter, size_t minLeaf) {
+  const size_t K = counter.size();
+  const int64_t N = std::accumulate(counter.begin(), counter.end(), int64_t(0));
+  if (present.size() < 2)
+      return {Question(), std::numeric_limits<float>::infinity()};
+
+  thread_local std::vector<int64_t> totals;
+  thread_local std::vector<size_t> order;
+  thread_local std::vector<int64_t> left_branch;
+  totals.resize(present.size());
+  for (size_t i = 0; i < present.size(); i++)
+      totals[i] = std::accumulate(counts + present[i] * K, counts + (present[i] + 1) * K, int64_t(0));
+
+  //orders the categories by increasing proportion of class k, ties by id
+  auto sort_by = [&](size_t k) {
+      order.resize(present.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+          return counts[present[a] * K + k] * totals[b] < counts[present[b] * K + k] * totals[a];
+      });
+  };
+
+  double best_score = -1;
+  size_t best_class = 0, best_prefix = 0;
+  for (size_t k = 0; k < (K == 2 ? 1 : K); k++) {
+      sort_by(k);
+      left_branch.assign(K, 0);
+      int64_t left_size = 0;
+      for (size_t i = 0; i + 1 < order.size(); i++) {
+          const Count* moved = counts + present[order[i]] * K;
+          for (size_t j = 0; j < K; j++)
+              left_branch[j] += moved[j];
+          left_size += totals[order[i]];
+
+          //both branches need at least minLeaf rows
+          if (left_size < static_cast<int64_t>(minLeaf) || N - left_size < static_cast<int64_t>(minLeaf)) continue;
+
+          int64_t left_squares = 0, right_squares = 0;
+          for (size_t j = 0; j < K; j++) {
+              const int64_t right = counter[j] - left_branch[j];
+              left_squares += left_branch[j] * left_branch[j];
+              right_squares += right * right;
+          }
+          const double score = static_cast<double>(left_squares)/left_size + static_cast<double>(right_squares)/(N-left_size);
+          if (score > best_score) {
+              best_score = score;
+              best_class = k;
+              best_prefix = i + 1;
+          }
+      }
+  }
+
+  if (best_score < 0)
+      return {Question(), std::numeric_limits<float>::infinity()};
+
+  sort_by(best_class);
+  std::vector<uint64_t> categories;
+  for (size_t i = 0; i < best_prefix; i++) {
+      const Category category = present[order[i]];
+      if (categories.size() <= category / 64)
+          categories.resize(category / 64 + 1, 0);
+      categories[category / 64] |= uint64_t(1) << (category % 64);
+  }
+  return {Question(column, std::move(categories)), (N - best_score)/N};
+}
+
+/**
+ * Method that evaluates every column and keeps the question with the highest
+ * gain. With a pool, the columns are evaluated in parallel, but the results are
+ * still reduced in column order, so ties are broken by the lowest column index
+ * and the outcome is identical to the sequential one.
+ *
+ * @param columns - columns to evaluate, in increasing order
+ * @param node_gini - gini index of the node
+ * @param evaluate - callable that returns the best question on a column and its weighted gini index
+ * @param pool - pool to evaluate the columns on, or nullptr
+ * @return - best gain and the question that produced it
+ */
+template <typename Evaluate>
+tuple<const double, const Question> best_column(const std::vector<size_t>& columns, double node_gini, Evaluate evaluate, ThreadPool* pool) {
   double best_gain = 0.0;  // keep track of the best information gain
   auto best_question = Question();  //keep track of the feature / value that produced it
 
-  //there has to be at least two datapoints to make a split
-  if (rows.size() <= 1){
+  auto keep_best = [&](const tuple<const Question, double>& result) {
+      double gini_index = std::get<1>(result);
+      if ((node_gini-gini_index) > best_gain){
+          best_gain = node_gini-gini_index;
+          best_question = std::get<0>(result);
+      }
+  };
+
+  if (pool == nullptr || columns.size() <= 1) {
+      for (const auto& column: columns)
+          keep_best(evaluate(column));
       return forward_as_tuple(best_gain, best_question);
   }
 
+  std::vector<std::future<tuple<const Question, double>>> results;
+  results.reserve(columns.size());
+  for (const auto& column: columns)
+      results.push_back(pool->submit([&evaluate, column]() { return evaluate(column); }));
+  for (auto& result: results)
+      keep_best(pool->wait(result));
+
+  return forward_as_tuple(best_gain, best_question);
+}
+
+/**
+ * Method that goes through all features and for each feature finds the best
+ * threshold and loss, keeping the question with the highest gain.
+ *
+ * @param rows - data set
+ * @param indexes - rows of the current node
+ * @param weights - weight of every row, or nullptr
+ * @param columns - columns to evaluate
+ * @param minLeaf - minimum number of rows in each branch
+ * @param sorted - callable that returns the rows of the node ordered on a column
+ * @param pool - pool to evaluate the columns on, or nullptr
+ * @return - best gain and the question that produced it
+ */
+template <typename Sorted>
+tuple<const double, const Question> best_split(const DataTable& rows, IndexRange indexes, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, Sorted sorted, ThreadPool* pool) {
+  //there has to be at least two distinct datapoints to make a split
+  if (indexes.size() <= 1){
+      return {0.0, Question()};
+  }
+
   //find current current class distribution
-  ClassCounter current_node_classes = classCounts(rows, indexes);
+  const std::vector<int> current_node_classes = Calculations::classCounts(rows, indexes, weights);
+  const double N = std::accumulate(current_node_classes.begin(), current_node_classes.end(), 0);
 
   //find current gini index
-  double best_gini = gini(current_node_classes, indexes.size());
+  double best_gini = Calculations::gini(current_node_classes.data(), current_node_classes.size(), N);
 
-  //going through all features and for each feature finding the best threshold and loss
-  for (int column = 0; column < meta.labels.size()-1; column++){
-      //presorting the list of indexes, based on the data values
-      std::vector<size_t> current_indexes = indexes;
-
-      if (meta.labelMap.find(meta.labels[column])->second == "NUMERIC"){
-          std::sort(current_indexes.begin(), current_indexes.end(), NumericComparator(column, rows));
-      } else {
-          std::sort(current_indexes.begin(), current_indexes.end(), StringComparator(column, rows));
-      }
+  return best_column(columns, best_gini, [&](size_t column) {
+      const IndexRange current_indexes = sorted(column);
 
       //determining best threshold to split the data
-      tuple<std::string, double> result = determine_best_threshold(rows, column, current_indexes, current_node_classes);
-      std::vector<size_t>().swap(current_indexes);
+      return Calculations::determine_best_threshold(rows, column, current_indexes, weights, current_node_classes, minLeaf);
+  }, pool);
+}
 
-      std::string threshold = std::get<0>(result);
-      double gini_index = std::get<1>(result);
+/**
+ * Method like best_split for a sparse table. The non-zero entries of the rows
+ * of the node are first regrouped by column, so every numeric column only
+ * sorts and scans its own non-zero rows instead of all rows of the node.
+ * Categorical columns are not indexed and are evaluated as usual.
+ */
+tuple<const double, const Question> best_sparse_split(const DataTable& rows, IndexRange indexes, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) {
+  if (indexes.size() <= 1){
+      return {0.0, Question()};
+  }
 
-      if ((best_gini-gini_index) > best_gain){
-          best_gain = best_gini-gini_index;
-          best_question = Question(column, threshold);
-      }
+  const std::vector<int> current_node_classes = Calculations::classCounts(rows, indexes, weights);
+  const double N = std::accumulate(current_node_classes.begin(), current_node_classes.end(), 0);
+  double best_gini = Calculations::gini(current_node_classes.data(), current_node_classes.size(), N);
+
+  //the rows of every column with a non-zero value (CSC), owned by this call since the column tasks may run on other threads
+  const uint32_t* entries = rows.nonZeroColumns();
+  std::vector<size_t> starts(rows.columns() + 1, 0);
+  for (const auto& index: indexes)
+      for (size_t entry = rows.nonZeroStart(index); entry < rows.nonZeroStart(index + 1); entry++)
+          starts[entries[entry] + 1]++;
+  std::partial_sum(starts.begin(), starts.end(), starts.begin());
+
+  std::vector<size_t> non_zeros(starts.back());
+  std::vector<size_t> next(starts.begin(), starts.end() - 1);
+  for (const auto& index: indexes)
+      for (size_t entry = rows.nonZeroStart(index); entry < rows.nonZeroStart(index + 1); entry++)
+          non_zeros[next[entries[entry]]++] = index;
+
+  return best_column(columns, best_gini, [&](size_t column) -> tuple<const Question, double> {
+      if (!rows.isNumeric(column))
+          return Calculations::determine_best_threshold(rows, column, indexes, weights, current_node_classes, minLeaf);
+
+      size_t* begin = non_zeros.data() + starts[column];
+      size_t* end = non_zeros.data() + starts[column + 1];
+      std::sort(begin, end, ColumnComparator(rows.numeric(column)));
+      const auto [threshold, loss] = scan_sparse_threshold(rows.numeric(column), rows.classes(), IndexRange(begin, end), indexes.size() - (end - begin), weights, current_node_classes, minLeaf);
+      return {Question(column, threshold), loss};
+  }, pool);
+}
+
+} // namespace
+
+/**
+ * Method that moves the rows of [begin, end) that answer the question with
+ * true to the front of the range. The order within the two parts is not kept.
+ *
+ * @return - end of the true rows, begin of the false rows
+ */
+size_t* Calculations::partition(const DataTable& data, const Question& q, size_t* begin, size_t* end) {
+  return std::partition(begin, end, [&](size_t index) { return q.solve(data, index); });
+}
+
+/**
+ * Method that partitions the rows [begin, end) of every column in place,
+ * without changing their order, so the children stay sorted and never have to
+ * be sorted again. The false rows wait in a per-thread buffer.
+ *
+ * @return - end of the true rows, begin of the false rows, the same in every column
+ */
+size_t Calculations::partition(const DataTable& data, const Question& q, SortedIndexes& sorted, size_t begin, size_t end) {
+  thread_local std::vector<size_t> false_indexes;
+  size_t middle = begin;
+
+  for (auto& column: sorted) {
+    false_indexes.clear();
+    size_t* out = column.data() + begin;
+    for (size_t i = begin; i < end; i++) {
+      const size_t index = column[i];
+      if (q.solve(data, index))
+        *out++ = index;
+      else
+        false_indexes.push_back(index);
+    }
+    std::copy(false_indexes.begin(), false_indexes.end(), out);
+    middle = out - column.data();
   }
 
-  return forward_as_tuple(best_gain, best_question);
+  return middle;
 }
 
-const double Calculations::gini(const ClassCounter& counts, double N) {
-  double impurity = 1.0;
+tuple<const double, const Question> Calculations::find_best_split(const DataTable& rows, IndexRange indexes, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) {
+  if (rows.isSparse()) {
+      return best_sparse_split(rows, indexes, weights, columns, minLeaf, pool);
+  }
+
+  return best_split(rows, indexes, weights, columns, minLeaf, [&rows, indexes](size_t column) -> IndexRange {
+      //sorting a per-thread copy of the indexes, based on the data values
+      //categorical columns are counted per category, in any order
+      if (!rows.isNumeric(column))
+          return indexes;
 
-  //computing the gini index
-  for (auto& it : counts){
-      double pk = std::pow((it.second/N), 2);
-      impurity -= pk;
+      thread_local std::vector<size_t> current_indexes;
+      current_indexes.assign(indexes.begin(), indexes.end());
+      std::sort(current_indexes.begin(), current_indexes.end(), ColumnComparator(rows.numeric(column)));
+      return current_indexes;
+  }, pool);
+}
+
+tuple<const double, const Question> Calculations::find_best_split(const DataTable& rows, const SortedIndexes& sorted, size_t begin, size_t end, const int* weights, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) {
+  if (sorted.empty()) {
+      return {0.0, Question()};
   }
-  return impurity;
+
+  //every column already holds the rows of the node in sorted order
+  return best_split(rows, IndexRange(sorted.front().data() + begin, sorted.front().data() + end), weights, columns, minLeaf, [&sorted, begin, end](size_t column) {
+      return IndexRange(sorted[column].data() + begin, sorted[column].data() + end);
+  }, pool);
 }
 
-tuple<std::string, double> Calculations::determine_best_threshold(const Data& data, int col, const std::vector<size_t>& indexes, const ClassCounter& counter) {
-  std::string best_thresh;
-  double best_loss = std::numeric_limits<float>::infinity();
+tuple<const double, const Question> Calculations::find_best_split(const DataTable& rows, const Binning& binning, const Histogram& histogram, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) {
+  if (binning.columns() == 0) {
+      return {0.0, Question()};
+  }
 
-  //left and right branch
-  ClassCounter left_branch = empty(counter);
-  ClassCounter right_branch = copy(counter);
+  //the class distribution of the node is the sum over the bins of any column
+  std::vector<int64_t> current_node_classes(histogram.numClasses(), 0);
+  for (size_t bin = 0; bin < binning.bins(0); bin++) {
+      const int64_t* counts = histogram.counts(binning.offset(0) + bin);
+      for (size_t k = 0; k < current_node_classes.size(); k++)
+          current_node_classes[k] += counts[k];
+  }
 
-  //going linear through whole dataset, trying to find the best threshold to split the dataset
-  for (int row = 1; row < indexes.size(); row++){
-      size_t index = indexes[row-1];
-      auto current_class = data[index][data[index].size()-1];// getting the class
+  const double N = std::accumulate(current_node_classes.begin(), current_node_classes.end(), int64_t(0));
+  if (N <= 1) {
+      return {0.0, Question()};
+  }
 
-      //updating the class counters as we go through the dataset
-      left_branch[current_class] += 1;
-      right_branch[current_class] -= 1;
+  double best_gini = gini(current_node_classes.data(), current_node_classes.size(), N);
 
-      //skipping over the updating the loss, until we find a datapoint of different value
-      size_t current_index = indexes[row];
-      if (data[index][col] == data[current_index][col]) continue;
+  return best_column(columns, best_gini, [&](size_t column) {
+      return determine_best_bin(rows, column, binning, histogram, current_node_classes, minLeaf);
+  }, pool);
+}
+
+/**
+ * Method that computes the gini index of dense class counts.
+ *
+ * @param counts - number of rows per class id
+ * @param numClasses - length of counts
+ * @param N - total number of rows
+ * @return - gini index
+ */
+const double Calculations::gini(const int* counts, size_t numClasses, double N) {
+  return 1.0 - sum_of_squares(counts, numClasses) / (N * N);
+}
+
+const double Calculations::gini(const int64_t* counts, size_t numClasses, double N) {
+  return 1.0 - sum_of_squares(counts, numClasses) / (N * N);
+}
+
+/**
+ * Method that computes the sum of the squared counts, with AVX2 or SSE2 when
+ * the library is compiled for it and a scalar loop otherwise.
+ */
+const double Calculations::sum_of_squares(const int* counts, size_t n) {
+  size_t i = 0;
+  double sum = 0.0;
+#if defined(__AVX2__)
+  __m256d acc = _mm256_setzero_pd();
+  for (; i + 4 <= n; i += 4) {
+    const __m256d values = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + i)));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(values, values));
+  }
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, acc);
+  sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= n; i += 2) {
+    const __m128d values = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(counts + i)));
+    acc = _mm_add_pd(acc, _mm_mul_pd(values, values));
+  }
+  alignas(16) double lanes[2];
+  _mm_store_pd(lanes, acc);
+  sum = lanes[0] + lanes[1];
+#endif
+  for (; i < n; i++)
+    sum += static_cast<double>(counts[i]) * counts[i];
+  return sum;
+}
+
+const double Calculations::sum_of_squares(const int64_t* counts, size_t n) {
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++)
+    sum += static_cast<double>(counts[i]) * counts[i];
+  return sum;
+}
 
-      double left_gini_index = gini(left_branch, row);
-      double right_gini_index = gini(right_branch, indexes.size()-row);
+/**
+ * Method that finds the best question on a column: a threshold for numeric
+ * columns, whose indexes have to be sorted on the column, and a set of
+ * categories for categorical columns, whose indexes can be in any order.
+ *
+ * @return - best question on the column and its weighted gini index
+ */
+tuple<const Question, double> Calculations::determine_best_threshold(const DataTable& data, int col, IndexRange indexes, const int* weights, const std::vector<int>& counter, size_t minLeaf) {
+  if (data.isNumeric(col)) {
+    const auto [threshold, loss] = scan_threshold(data.numeric(col), data.classes(), indexes, weights, counter, minLeaf);
+    return {Question(col, threshold), loss};
+  }
+
+  //class counts per category in per-thread buffers, which are all zero between calls
+  const size_t K = counter.size();
+  thread_local std::vector<int> counts;
+  thread_local std::vector<Category> present;
+  present.clear();
+  const Category* categories = data.categories(col);
+  const Category* classes = data.classes();
+  for (const auto& index: indexes) {
+    const Category category = categories[index];
+    if (counts.size() < (category + 1) * K)
+      counts.resize((category + 1) * K, 0);
+    int* category_counts = counts.data() + category * K;
+    if (std::all_of(category_counts, category_counts + K, [](int c) { return c == 0; }))
+      present.push_back(category);
+    category_counts[classes[index]] += weight(weights, index);
+  }
+  std::sort(present.begin(), present.end());
+
+  auto result = best_subset(col, counts.data(), present, counter, minLeaf);
+  for (const auto& category: present)
+    std::fill_n(counts.begin() + category * K, K, 0);
+  return result;
+}
+
+/**
+ * Method that scans the bins of a column in order, which costs O(bins) instead
+ * of O(rows). A threshold is only evaluated at the lower edge of a non-empty
+ * bin. The edges are computed over the whole training set, so the node need
+ * not hold a row with that value, but no row of the node falls strictly
+ * between the two sides.
+ *
+ * @param data - data set
+ * @param col - column to split
+ * @param binning - quantization of the data set
+ * @param histogram - class counts per bin of the rows of the node
+ * @param counter - class counts of the node
+ * @param minLeaf - minimum number of rows in each branch
+ * @return - best question on the column and its weighted gini index
+ */
+tuple<const Question, double> Calculations::determine_best_bin(const DataTable& data, int col, const Binning& binning, const Histogram& histogram, const std::vector<int64_t>& counter, size_t minLeaf) {
+  //the bins of a categorical column are its categories
+  if (!data.isNumeric(col)) {
+    thread_local std::vector<Category> present;
+    present.clear();
+    for (size_t bin = 0; bin < binning.bins(col); bin++) {
+      const int64_t* counts = histogram.counts(binning.offset(col) + bin);
+      if (std::any_of(counts, counts + counter.size(), [](int64_t c) { return c != 0; }))
+        present.push_back(bin);
+    }
+    return best_subset(col, histogram.counts(binning.offset(col)), present, counter, minLeaf);
+  }
+
+  size_t best_bin = 0;
+  double best_loss = std::numeric_limits<float>::infinity();
+
+  const size_t K = counter.size();
+  const double N = std::accumulate(counter.begin(), counter.end(), int64_t(0));
+
+  //per-thread buffers, so scanning a column does not allocate
+  thread_local std::vector<int64_t> left_branch;
+  thread_local std::vector<int64_t> right_branch;
+  left_branch.assign(K, 0);
+  right_branch.assign(counter.begin(), counter.end());
+  double left_size = 0;
+
+  for (size_t bin = 1; bin < binning.bins(col); bin++) {
+      const int64_t* previous = histogram.counts(binning.offset(col) + bin - 1);
+      int64_t moved = 0;
+      for (size_t k = 0; k < K; k++) {
+          left_branch[k] += previous[k];
+          right_branch[k] -= previous[k];
+          moved += previous[k];
+      }
+      left_size += moved;
 
-      double current_gini = ((row+1)*left_gini_index + (indexes.size()-row-1)*right_gini_index)/indexes.size();
+      const int64_t* current = histogram.counts(binning.offset(col) + bin);
+      if (left_size == 0 || left_size == N || std::all_of(current, current + K, [](int64_t c) { return c == 0; }))
+          continue;
+      if (left_size < minLeaf || N - left_size < minLeaf)
+          continue;
 
+      const double right_size = N - left_size;
+      double left_gini_index = gini(left_branch.data(), K, left_size);
+      double right_gini_index = gini(right_branch.data(), K, right_size);
+
+      double current_gini = (left_size*left_gini_index + right_size*right_gini_index)/N;
       if (current_gini < best_loss){
           best_loss = current_gini;
-          best_thresh = data[current_index][col];
+          best_bin = bin;
       }
   }
 
-  return forward_as_tuple(best_thresh, best_loss);
+  if (best_bin == 0)
+      return {Question(), best_loss};
+  return {binning.question(col, best_bin), best_loss};
 }
 
-const ClassCounter Calculations::classCounts(const Data& data, const std::vector<size_t>& indexes) {
-  ClassCounter counter;
+const std::vector<int> Calculations::classCounts(const DataTable& data, IndexRange indexes, const int* weights) {
+  std::vector<int> counter(data.numClasses(), 0);
+  const Category* classes = data.classes();
   for (const auto& index: indexes) {
-    auto rows = data[index];
-    const string decision = *std::rbegin(rows);
-    if (counter.find(decision) != std::end(counter)) {
-      counter.at(decision)++;
-    } else {
-      counter[decision] += 1;
-    }
+    counter[classes[index]] += weight(weights, index);
   }
   return counter;
 }
 
-const ClassCounter Calculations::copy(const ClassCounter &current) {
-    ClassCounter counter;
-    for (auto &it : current){
-        counter[it.first] = it.second;
-    }
-    return counter;
+const std::vector<size_t> Calculations::allColumns(const DataTable& data) {
+  std::vector<size_t> columns(data.columns());
+  std::iota(columns.begin(), columns.end(), 0);
+  return columns;
 }
 
-const ClassCounter Calculations::empty(const ClassCounter &current) {
-    ClassCounter counter;
-    for (auto &it : current){
-        counter[it.first] = 0;
-    }
-    return counter;
+const ClassCounter Calculations::toClassCounter(const std::vector<int>& counts) {
+  ClassCounter counter;
+  for (size_t k = 0; k < counts.size(); k++) {
+    if (counts[k] > 0)
+      counter[k] = counts[k];
+  }
+  return counter;
+}
+
+const SortedIndexes Calculations::presort(const DataTable &data, const std::vector<size_t>& indexes) {
+  SortedIndexes sorted(data.columns(), indexes);
+  for (size_t column = 0; column < data.columns(); column++) {
+    //categorical columns are counted per category and need no order
+    if (data.isNumeric(column))
+      std::sort(sorted[column].begin(), sorted[column].end(), ColumnComparator(data.numeric(column)));
+  }
+  return sorted;
+}
+
+/**
+ * Method that derives the presorted order of a weighted sample (e.g. a
+ * bootstrap) from the presorted order of the whole data set, by keeping the
+ * rows with a positive weight. This takes linear time instead of sorting again.
+ *
+ * @param sorted - presorted order of all rows
+ * @param weights - weight of every row, 0 for the rows that are not in the sample
+ * @return - presorted order of the sampled rows, each row once
+ */
+const SortedIndexes Calculations::sample(const SortedIndexes &sorted, const Weights& weights) {
+  if (sorted.empty())
+    return {};
+
+  const size_t rows = std::count_if(weights.begin(), weights.end(), [](int weight) { return weight > 0; });
+  SortedIndexes sampled(sorted.size());
+  for (size_t column = 0; column < sorted.size(); column++) {
+    sampled[column].reserve(rows);
+    for (const auto& index: sorted[column])
+      if (weights[index] > 0)
+        sampled[column].push_back(index);
+  }
+  return sampled;
 }
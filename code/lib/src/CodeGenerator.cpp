@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "CodeGenerator.hpp"
+
+using std::ostream;
+using std::string;
+
+namespace {
+
+/**
+ * Method that writes a float as a literal that parses back to the same value.
+ */
+string literal(float value) {
+  if (std::isinf(value))
+    return value < 0 ? "-std::numeric_limits<float>::infinity()" : "std::numeric_limits<float>::infinity()";
+  std::ostringstream out;
+  out.precision(std::numeric_limits<float>::max_digits10);
+  out << std::showpoint << value << "f";
+  return out.str();
+}
+
+string quoted(const string& value) {
+  string result = "\"";
+  for (const char c: value) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+/**
+ * Method that writes the nodes of a tree as a flat sequence of labelled blocks
+ * in depth-first order. The true child of a node is the next node, so a
+ * question falls through when it holds and jumps to its false child
+ * otherwise: the source stays flat however deep the tree is.
+ */
+void generateNodes(ostream& out, const FlatTree& tree, size_t number) {
+  std::vector<bool> target(tree.size(), false);
+  for (size_t index = 0; index < tree.size(); index++)
+    if (tree.nodes()[index].feature >= 0)
+      target[tree.nodes()[index].falseChild] = true;
+
+  for (size_t index = 0; index < tree.size(); index++) {
+    const FlatNode& node = tree.nodes()[index];
+    if (target[index])
+      out << "n" << index << ":\n";
+    if (node.feature < 0)
+      out << "  return " << node.falseChild << ";\n";
+    else if (node.numeric)
+      out << "  if (!(x[" << node.feature << "] >= " << literal(node.threshold) << ")) goto n" << node.falseChild << ";\n";
+    else
+      out << "  if (!contains(tree" << number << "_sets + " << node.categories << ", x[" << node.feature << "])) goto n" << node.falseChild << ";\n";
+  }
+}
+
+void generateTree(ostream& out, const FlatTree& tree, size_t number) {
+  out << "\nconst int tree" << number << "_class[] = {";
+  for (size_t leaf = 0; leaf < tree.leaves(); leaf++)
+    out << (leaf % 16 == 0 ? "\n  " : " ") << tree.leafClass(leaf) << ",";
+  out << "\n};\n";
+
+  out << "\nconst float tree" << number << "_proba[] = {";
+  for (size_t value = 0; value < tree.leaves() * tree.numClasses(); value++)
+    out << (value % 8 == 0 ? "\n  " : " ") << literal(tree.leafProbabilities()[value]) << ",";
+  out << "\n};\n";
+
+  //category sets of the categorical questions, see FlatTree
+  if (tree.categoryWordCount() > 0) {
+    out << "\nconst unsigned tree" << number << "_sets[] = {";
+    for (size_t word = 0; word < tree.categoryWordCount(); word++)
+      out << (word % 8 == 0 ? "\n  " : " ") << tree.categoryWords()[word] << "u,";
+    out << "\n};\n";
+  }
+
+  //returns the index of the leaf the example ends up in
+  out << "\ninline int tree" << number << "(const float* x) {\n";
+  generateNodes(out, tree, number);
+  out << "}\n";
+}
+
+} // namespace
+
+namespace CodeGenerator {
+
+/**
+ * Method that writes the source of a compiled model.
+ *
+ * @param out - stream that receives the source
+ * @param trees - trees of the model (one tree or the trees of a bag)
+ * @param schema - schema of the training data, see DataTable::schema
+ */
+void generate(ostream& out, const std::vector<const FlatTree*>& trees, const MetaData& schema) {
+  if (trees.empty())
+    throw std::invalid_argument("A model needs at least one tree");
+
+  const size_t features = schema.labels.empty() ? 0 : schema.labels.size() - 1;
+  const size_t classes = trees.front()->numClasses();
+  const string class_label = schema.labels.empty() ? "" : schema.labels.back();
+
+  out << "// Generated by the DecisionTree library, do not edit.\n//\n"
+      << "// Features, in the order of the input array:\n";
+  for (size_t column = 0; column < features; column++) {
+    const string& label = schema.labels[column];
+    const auto type = schema.labelMap.find(label);
+    out << "//   x[" << column << "] " << label;
+    if (type != std::end(schema.labelMap) && type->second == "NUMERIC") {
+      out << " (numeric)\n";
+      continue;
+    }
+    out << " (categorical:";
+    if (const auto domain = schema.domains.find(label); domain != std::end(schema.domains))
+      for (size_t id = 0; id < domain->second.size(); id++)
+        out << " " << id << "=" << domain->second[id];
+    out << ")\n";
+  }
+
+  out << "\n#include <limits>\n\n"
+      << "#define MODEL_EXPORT extern \"C\" __attribute__((visibility(\"default\")))\n\nnamespace {\n\n"
+      << "//set: number of words, then bit c of the words is category id c\n"
+      << "inline bool contains(const unsigned* set, float x) {\n"
+      << "  if (!(x >= 0.0f && x < 4294967296.0f)) //negative, missing (-inf), NaN or too large for the cast: in no set\n"
+      << "    return false;\n"
+      << "  const unsigned c = static_cast<unsigned>(x);\n"
+      << "  return c / 32 < set[0] && ((set[1 + c / 32] >> (c % 32)) & 1u);\n}\n";
+  for (size_t tree = 0; tree < trees.size(); tree++)
+    generateTree(out, *trees[tree], tree);
+
+  size_t names = 0;
+  out << "\nconst char* const class_names[] = {";
+  if (const auto domain = schema.domains.find(class_label); domain != std::end(schema.domains)) {
+    for (const auto& name: domain->second)
+      out << "\n  " << quoted(name) << ",";
+    names = domain->second.size();
+  }
+  out << "\n  \"\",\n};\n\n";
+
+  if (trees.size() > 1) {
+    out << "void votes(const float* x, int* counts) {\n"
+        << "  for (int k = 0; k < " << classes << "; k++)\n    counts[k] = 0;\n";
+    for (size_t tree = 0; tree < trees.size(); tree++)
+      out << "  counts[tree" << tree << "_class[tree" << tree << "(x)]]++;\n";
+    out << "}\n\n";
+  }
+  out << "} // namespace\n\n";
+
+  out << "MODEL_EXPORT int num_features() { return " << features << "; }\n"
+      << "MODEL_EXPORT int num_classes() { return " << classes << "; }\n"
+      << "MODEL_EXPORT const char* class_name(int id) {\n"
+      << "  return id >= 0 && id < " << names << " ? class_names[id] : \"\";\n}\n\n";
+
+  if (trees.size() == 1) {
+    out << "MODEL_EXPORT int predict(const float* x) {\n"
+        << "  return tree0_class[tree0(x)];\n}\n\n"
+        << "MODEL_EXPORT void predict_proba(const float* x, float* out) {\n"
+        << "  const float* proba = tree0_proba + tree0(x) * " << classes << ";\n"
+        << "  for (int k = 0; k < " << classes << "; k++)\n    out[k] = proba[k];\n}\n";
+    return;
+  }
+
+  out << "MODEL_EXPORT int predict(const float* x) {\n"
+      << "  int counts[" << classes << "];\n  votes(x, counts);\n  int best = 0;\n"
+      << "  for (int k = 1; k < " << classes << "; k++)\n    if (counts[k] > counts[best])\n      best = k;\n"
+      << "  return best;\n}\n\n"
+      << "MODEL_EXPORT void predict_proba(const float* x, float* out) {\n"
+      << "  int counts[" << classes << "];\n  votes(x, counts);\n"
+      << "  for (int k = 0; k < " << classes << "; k++)\n    out[k] = counts[k] / " << trees.size() << ".0f;\n}\n";
+}
+
+void generate(const string& filename, const std::vector<const FlatTree*>& trees, const MetaData& schema) {
+  std::ofstream out(filename);
+  generate(out, trees, schema);
+  if (!out)
+    throw std::runtime_error("Can't write file: " + filename);
+}
+
+} // namespace CodeGenerator
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include "CostComplexity.hpp"
+
+namespace {
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+/**
+ * Change of the minimal cost of a subtree at alpha, where one of its nodes is
+ * collapsed: the errors grow by value and the leaves drop by slope.
+ */
+struct Drop {
+  double alpha;
+  double slope;
+  double value;
+};
+
+/**
+ * Minimal cost of a subtree as a function of alpha: value + slope * alpha up
+ * to the first drop, where value is the number of errors and the slope the
+ * number of leaves, and the drops, increasing. Errors and leaves are whole
+ * numbers, so every alpha is one division and equal alphas are equal doubles.
+ */
+struct Cost {
+  double value;
+  double slope;
+  std::vector<Drop> drops;
+};
+
+} // namespace
+
+/**
+ * Constructor that computes the pruning alpha of every node, see CostComplexity.
+ *
+ * @param arena - nodes of the tree, must outlive the object
+ * @param root - index of the root in the arena
+ */
+CostComplexity::CostComplexity(const NodeArena& arena, uint32_t root) :
+    arena_(arena),
+    root_(root),
+    counts_(arena.size() * arena.numClasses(), 0),
+    alphas_(arena.size(), infinity) {
+  const size_t K = arena_.numClasses();
+
+  //bottom up: the class counts of every node and the alpha at which it would be collapsed within its own subtree
+  std::function<Cost(uint32_t)> cost = [&](uint32_t id) -> Cost {
+    const ArenaNode& node = arena_.node(id);
+    int* counts = counts_.data() + id * K;
+    if (node.leaf >= 0) {
+      std::copy_n(arena_.counts(node), K, counts);
+    }
+
+    Cost children{0, 0, {}};
+    if (node.leaf < 0) {
+      Cost left = cost(node.trueChild);
+      Cost right = cost(node.falseChild);
+      for (size_t k = 0; k < K; k++)
+        counts[k] = counts_[node.trueChild * K + k] + counts_[node.falseChild * K + k];
+
+      children.value = left.value + right.value;
+      children.slope = left.slope + right.slope;
+      children.drops.resize(left.drops.size() + right.drops.size());
+      std::merge(left.drops.begin(), left.drops.end(), right.drops.begin(), right.drops.end(), children.drops.begin(),
+                 [](const Drop& a, const Drop& b) { return a.alpha < b.alpha; });
+    }
+
+    const double total = std::accumulate(counts, counts + K, 0.0);
+    const double errors = total - *std::max_element(counts, counts + K);
+    const double leaf = errors; // cost of the node as a leaf at alpha 0, the slope is 1
+    if (node.leaf >= 0)
+      return Cost{leaf, 1, {}};
+
+    //walk the segments of the children's cost until it meets leaf + alpha; the children's slope is at least 2
+    double from = 0, value = children.value, slope = children.slope;
+    size_t drop = 0;
+    double meet = infinity;
+    while (true) {
+      const double crossing = std::max(from, (leaf - value) / (slope - 1));
+      const double to = drop < children.drops.size() ? children.drops[drop].alpha : infinity;
+      if (crossing <= to) {
+        meet = crossing;
+        break;
+      }
+      value += children.drops[drop].value;
+      slope -= children.drops[drop].slope;
+      from = to;
+      drop++;
+    }
+    alphas_[id] = meet;
+
+    if (meet == 0)
+      return Cost{leaf, 1, {}};
+    children.drops.resize(drop);
+    children.drops.push_back(Drop{meet, slope - 1, leaf - value});
+    return children;
+  };
+  cost(root_);
+
+  //costs are relative to the rows of the root
+  const double rows = std::accumulate(counts_.begin() + root_ * K, counts_.begin() + (root_ + 1) * K, 0.0);
+  for (auto& alpha: alphas_)
+    alpha /= rows > 0 ? rows : 1;
+
+  //top down: a node is pruned as soon as one of its ancestors is
+  std::function<void(uint32_t, double)> inherit = [&](uint32_t id, double parent) {
+    alphas_[id] = std::min(alphas_[id], parent);
+    const ArenaNode& node = arena_.node(id);
+    if (node.leaf < 0) {
+      inherit(node.trueChild, alphas_[id]);
+      inherit(node.falseChild, alphas_[id]);
+    } else {
+      alphas_[id] = infinity;
+    }
+  };
+  inherit(root_, infinity);
+}
+
+/**
+ * Method that returns the alphas at which the subtree of minimal cost changes,
+ * increasing and starting at 0 for the full tree.
+ */
+std::vector<double> CostComplexity::path() const {
+  std::vector<double> alphas{0};
+  for (const auto& alpha: alphas_)
+    if (alpha != infinity)
+      alphas.push_back(alpha);
+  std::sort(alphas.begin(), alphas.end());
+  alphas.erase(std::unique(alphas.begin(), alphas.end()), alphas.end());
+  return alphas;
+}
+
+/**
+ * Method that chooses alpha on held-out rows, e.g. a validation set or the
+ * out-of-bag rows of a bagged tree. Every row follows its path in the full
+ * tree once: it is classified by the first node on that path that is a leaf
+ * for alpha, and as the pruning alphas only decrease along the path, every
+ * node on it is that node for one interval of alphas.
+ *
+ * @param data - data set, encoded with the dictionaries of the training data
+ * @param rows - held-out rows of the data set
+ * @return - the alpha of the path with the highest accuracy, the largest one among equals
+ */
+double CostComplexity::select(const DataTable& data, IndexRange rows) const {
+  const std::vector<double> alphas = path();
+  if (alphas.empty())
+    return 0;
+
+  //correct[i] - correct[i - 1] is the change of the number of correct rows at alphas[i]
+  std::vector<int64_t> correct(alphas.size() + 1, 0);
+  const Category* classes = data.classes();
+  for (const auto& row: rows) {
+    uint32_t id = root_;
+    double upper = infinity;
+    while (true) {
+      const ArenaNode& node = arena_.node(id);
+      const double lower = node.leaf >= 0 ? -infinity : alphas_[id];
+      if (majority(id) == classes[row] && lower < upper) {
+        correct[std::lower_bound(alphas.begin(), alphas.end(), lower) - alphas.begin()]++;
+        correct[std::lower_bound(alphas.begin(), alphas.end(), upper) - alphas.begin()]--;
+      }
+      if (node.leaf >= 0)
+        break;
+      upper = lower;
+      id = node.question.solve(data, row) ? node.trueChild : node.falseChild;
+    }
+  }
+
+  size_t best = 0;
+  int64_t running = 0, best_correct = -1;
+  for (size_t i = 0; i < alphas.size(); i++) {
+    running += correct[i];
+    if (running >= best_correct) {
+      best_correct = running;
+      best = i;
+    }
+  }
+  return alphas[best];
+}
+
+/**
+ * Method that copies the subtree of minimal cost for alpha into an arena: every
+ * node whose pruning alpha is at most alpha is collapsed into a leaf with the
+ * class counts of its rows.
+ *
+ * @param alpha - complexity parameter
+ * @param pruned - empty arena that receives the nodes
+ * @return - index of the root in pruned
+ */
+uint32_t CostComplexity::prune(double alpha, NodeArena& pruned) const {
+  const size_t K = arena_.numClasses();
+  std::function<uint32_t(uint32_t)> copy = [&](uint32_t id) -> uint32_t {
+    const ArenaNode& node = arena_.node(id);
+    if (node.leaf >= 0 || alphas_[id] <= alpha)
+      return pruned.addLeaf(std::vector<int>(counts_.begin() + id * K, counts_.begin() + (id + 1) * K));
+    const uint32_t trueChild = copy(node.trueChild);
+    const uint32_t falseChild = copy(node.falseChild);
+    return pruned.addSplit(node.question, trueChild, falseChild);
+  };
+  return copy(root_);
+}
+
+/**
+ * Method that returns the majority class of the rows of a node, ties going to
+ * the lowest class id like FlatTree.
+ */
+Category CostComplexity::majority(uint32_t node) const {
+  const int* counts = counts_.data() + node * arena_.numClasses();
+  return std::max_element(counts, counts + arena_.numClasses()) - counts;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unistd.h>
+#include "BinaryFile.hpp"
+#include "DataCache.hpp"
+#include "MappedFile.hpp"
+
+using std::string;
+using BinaryFile::Reader;
+using BinaryFile::Writer;
+
+namespace {
+
+constexpr char magic[8] = {'C', 'A', 'R', 'T', 'D', 'A', 'T', 'A'};
+constexpr uint32_t byte_order = 0x01020304;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t sourceSize;
+  int64_t sourceTime; // modification time of the source in nanoseconds
+  uint64_t rows;
+  uint64_t columns;
+};
+
+/**
+ * Size and modification time of the source file, both 0 when it is missing.
+ */
+std::pair<uint64_t, int64_t> stamp(const string& source) {
+  std::error_code error;
+  const auto size = std::filesystem::file_size(source, error);
+  if (error)
+    return {0, 0};
+  const auto time = std::filesystem::last_write_time(source, error);
+  if (error)
+    return {0, 0};
+  return {size, std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count()};
+}
+
+} // namespace
+
+/**
+ * Method that opens a cache file, if it is up to date with its source.
+ *
+ * The columns of the table point into the mapping, which stays open as long as
+ * the table (or a copy of it) uses it. When the source file is missing, the
+ * cache is used as is.
+ *
+ * @param cache - path of the cache file
+ * @param source - path of the ARFF file the cache was made from
+ * @param classLabel - class label the data was read with
+ * @param data - receives the table
+ * @param meta - receives the meta data
+ * @return - false when the cache is missing, stale or damaged
+ */
+bool DataCache::read(const string& cache, const string& source, const string& classLabel,
+                     DataTable& data, MetaData& meta) {
+  auto file = std::make_shared<const MappedFile>(cache);
+  if (file->size() < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, file->data(), sizeof(Header));
+  const auto [size, time] = stamp(source);
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.byteOrder != byte_order)
+    return false;
+  if ((size != 0 || time != 0) && (header.sourceSize != size || header.sourceTime != time))
+    return false;
+  if (header.rows > file->size() / 4 || header.columns > file->size())
+    return false;
+
+  try {
+    Reader reader(file->data(), file->size());
+    reader.bytes(sizeof(Header));
+    if (reader.text() != classLabel)
+      return false;
+
+    MetaData cached = reader.meta();
+
+    DataTable table(cached);
+    if (table.columns() != header.columns)
+      return false;
+    for (size_t column = 0; column < table.columns(); column++)
+      for (const auto& value: reader.texts())
+        table.dictionaries_[column].encode(value);
+    for (const auto& value: reader.texts())
+      table.classDictionary_.encode(value);
+    reader.align();
+
+    table.rows_ = header.rows;
+    for (size_t column = 0; column < table.columns(); column++) {
+      const char* values = reader.bytes(header.rows * 4);
+      if (table.numericColumn_[column])
+        table.numericView_[column] = reinterpret_cast<const float*>(values);
+      else
+        table.categoricalView_[column] = reinterpret_cast<const Category*>(values);
+      reader.align();
+    }
+    table.classesView_ = reinterpret_cast<const Category*>(reader.bytes(header.rows * 4));
+    table.mapping_ = std::move(file);
+
+    data = std::move(table);
+    meta = std::move(cached);
+  } catch (const std::exception&) { //damaged sizes end the reader or fail an allocation
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Method that writes a table to a cache file. The file is written next to its
+ * final name and renamed when complete, so readers never see a partial cache.
+ * The temporary name holds the process id and a counter, so processes and
+ * threads that build the same cache at once do not write to the same file.
+ *
+ * @param cache - path of the cache file
+ * @param source - path of the ARFF file the table was read from
+ * @param classLabel - class label the data was read with
+ * @return - false when the cache could not be written, the next read parses the source again
+ */
+bool DataCache::write(const string& cache, const string& source, const string& classLabel,
+                      const DataTable& data, const MetaData& meta) {
+  static_assert(sizeof(float) == 4 && sizeof(Category) == 4, "columns are stored as 4-byte values");
+
+  static std::atomic<unsigned> writes(0);
+  const string temporary = cache + "." + std::to_string(getpid()) + "." + std::to_string(writes++) + ".tmp";
+  {
+    Writer writer(temporary);
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byteOrder = byte_order;
+    std::tie(header.sourceSize, header.sourceTime) = stamp(source);
+    header.rows = data.rows();
+    header.columns = data.columns();
+    writer.bytes(&header, sizeof(Header));
+
+    writer.text(classLabel);
+    writer.meta(meta);
+    for (size_t column = 0; column < data.columns(); column++)
+      writer.texts(data.isNumeric(column) ? VecS() : data.dictionary(column));
+    writer.texts(data.classNames());
+    writer.align();
+
+    for (size_t column = 0; column < data.columns(); column++) {
+      if (data.isNumeric(column))
+        writer.bytes(data.numeric(column), data.rows() * sizeof(float));
+      else
+        writer.bytes(data.categories(column), data.rows() * sizeof(Category));
+      writer.align();
+    }
+    writer.bytes(data.classes(), data.rows() * sizeof(Category));
+
+    if (!writer.good()) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporary.c_str(), cache.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
@@ -4,57 +4,164 @@
  * Written by Pieter Robberechts, 2019
  */
 
-#include <thread>
+#include <charconv>
+#include "DataCache.hpp"
 #include "DataReader.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
 
 using boost::algorithm::split;
-using boost::timer::cpu_timer;
+
+namespace {
+
+std::string_view trim(std::string_view value) {
+  const size_t first = value.find_first_not_of(" \n\r\t");
+  if (first == value.npos)
+    return std::string_view();
+  return value.substr(first, value.find_last_not_of(" \n\r\t") - first + 1);
+}
+
+/**
+ * Method that appends the cells of a row, once all of its numeric cells are
+ * known to parse, so a malformed row leaves the table unchanged.
+ *
+ * @return - false when a numeric cell is not a number, the row is then skipped
+ */
+bool appendRow(const std::vector<std::string_view>& cells, DataTable& data, const std::vector<size_t>& columns) {
+  thread_local std::vector<float> values;
+  values.resize(cells.size());
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (columns[i] < data.columns() && data.isNumeric(columns[i]) && !DataTable::parseNumeric(cells[i], values[i]))
+      return false;
+  }
+
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (columns[i] == data.columns())
+      data.appendClass(cells[i]);
+    else if (data.isNumeric(columns[i]))
+      data.append(columns[i], values[i]);
+    else
+      data.append(columns[i], cells[i]);
+  }
+  return true;
+}
+
+} // namespace
 
 DataReader::DataReader(const Dataset& dataset) :
     classLabel_(dataset.classLabel),
-    trainData_({}),
-    testData_({}),
+    useCache_(dataset.useCache),
+    trainData_(),
+    testData_(),
     trainMetaData_({}),
     testMetaData_({}) {
-  std::cout << "Start reading data set." << std::endl; cpu_timer timer;
-  std::thread readTestingData([this, &dataset]() {
-    return processFile(dataset.train.filename, trainData_, trainMetaData_);
-  });
-
-  std::thread readTrainingData([this, &dataset]() {
-    return processFile(dataset.test.filename, testData_, testMetaData_);
-  });
-
-  readTrainingData.join();
-  readTestingData.join();
-  std::cout << "Done. " << timer.format() << std::endl;
-
-  if (!classLabel_.empty())
-    moveClassLabelToBack();
+  ThreadPool pool;
+  {
+    Profiler::Scope scope(dataset.profiler.get(), "parse", 0, true);
+    processFile(dataset.train.filename, trainData_, trainMetaData_, pool, dataset.profiler.get());
+    scope.setItems(trainData_.rows());
+  }
+  {
+    Profiler::Scope scope(dataset.profiler.get(), "parse", 0, true);
+    processFile(dataset.test.filename, testData_, testMetaData_, pool, dataset.profiler.get());
+    scope.setItems(testData_.rows());
+  }
 
-  if (trainData_.empty())
+  if (trainData_.rows() == 0)
     throw std::runtime_error("Can't open file: " + dataset.train.filename);
 
-  if (testData_.empty())
+  if (testData_.rows() == 0)
     throw std::runtime_error("Can't open file: " + dataset.test.filename);
+
+  testData_.conform(trainData_);
+  trainData_.indexSparse();
 }
 
-void DataReader::processFile(const std::string& filename, Data& data, MetaData &meta) {
-  std::ifstream file(filename);
-  if (!file)
+/**
+ * Method that reads an ARFF file into a data table.
+ *
+ * The file is memory-mapped. The header is parsed line by line, the data
+ * section is split into line-aligned chunks that are parsed in parallel into
+ * tables of their own and appended in file order.
+ *
+ * With useCache, an up-to-date binary cache of the file is mapped instead,
+ * and a missing or stale one is rewritten after parsing.
+ *
+ * @param filename - path of the ARFF file
+ * @param data - receives the rows
+ * @param meta - receives the attributes declared in the header
+ * @param pool - threads that parse the chunks
+ * @param profiler - records a cache that could not be written, may be null
+ */
+void DataReader::processFile(const std::string& filename, DataTable& data, MetaData &meta, ThreadPool& pool, Profiler* profiler) {
+  const std::string cache = DataCache::path(filename);
+  if (useCache_ && DataCache::read(cache, filename, classLabel_, data, meta))
     return;
 
-  std::string line;
+  const MappedFile file(filename);
+  const std::string_view content = file.view();
+
+  size_t position = 0;
   bool header_loaded = false;
+  while (position < content.size() && !header_loaded) {
+    const size_t end = std::min(content.find('\n', position), content.size());
+    parseHeaderLine(std::string(content.substr(position, end - position)), meta, header_loaded);
+    position = end + 1;
+  }
+  if (!header_loaded)
+    return;
 
-  while (getline(file, line)) {
-    if (!header_loaded) {
-      parseHeaderLine(line, meta, header_loaded);
-    } else {
-      parseDataLine(line, data, meta);
-    }
+  const std::vector<size_t> columns = moveClassLabelToBack(meta, classLabel_); //position of each attribute of the file in the data table
+  data = DataTable(meta);
+  parseRows(position < content.size() ? content.substr(position) : std::string_view(), data, meta, columns, pool);
+
+  if (useCache_ && !DataCache::write(cache, filename, classLabel_, data, meta) && profiler) {
+    const auto now = Profiler::Clock::now();
+    profiler->record("cache write failed", now, now);
   }
-  file.close();
+}
+
+/**
+ * Method that parses whole lines of the data section: they are split into
+ * line-aligned chunks that are parsed in parallel and appended in order.
+ *
+ * @param rows - lines to parse
+ * @param data - receives the rows
+ * @param meta - attributes of the file, after moveClassLabelToBack
+ * @param columns - column of every attribute in the data table
+ */
+void DataReader::parseRows(std::string_view rows, DataTable &data, const MetaData &meta, const std::vector<size_t> &columns, ThreadPool& pool) {
+  //chunks of at least a few MB, a few per thread to balance uneven lines
+  constexpr size_t min_chunk = 4 << 20;
+  const size_t chunk_size = std::max(min_chunk, rows.size() / (4 * pool.size()) + 1);
+
+  std::vector<std::future<DataTable>> chunks;
+  for (size_t begin = 0; begin < rows.size(); ) {
+    size_t end = std::min(begin + chunk_size, rows.size());
+    end = std::min(rows.find('\n', end - 1), rows.size()); //a chunk ends on a line break
+    const std::string_view chunk = rows.substr(begin, end - begin);
+    chunks.push_back(pool.submit([chunk, &meta, &columns]() { return parseChunk(chunk, meta, columns); }));
+    begin = end + 1;
+  }
+
+  for (auto& chunk: chunks)
+    data.append(pool.wait(chunk));
+}
+
+/**
+ * Method that parses a line-aligned part of the data section.
+ *
+ * @return - table with the rows of the chunk, encoded with dictionaries of its own
+ */
+DataTable DataReader::parseChunk(std::string_view chunk, const MetaData &meta, const std::vector<size_t> &columns) {
+  DataTable data(meta);
+  for (size_t position = 0; position < chunk.size(); ) {
+    const size_t end = std::min(chunk.find('\n', position), chunk.size());
+    if (!parseDataLine(chunk.substr(position, end - position), data, columns))
+      data.skipRow();
+    position = end + 1;
+  }
+  return data;
 }
 
 bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &header_loaded) {
@@ -95,19 +202,30 @@ bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &
       return true;
     }
 
-    len = std::string(" REAL").size();
-    if (s.size() > (size_t) len
-        && strcasecmp(s.substr(s.size() - len, len).c_str(), " REAL") == 0) {
-      s = s.substr(0, s.size() - len);
-      meta.labels.push_back(s);
-      return true;
+    for (const std::string type: {" REAL", " INTEGER"}) {
+      len = type.size();
+      if (s.size() > (size_t) len
+          && strcasecmp(s.substr(s.size() - len, len).c_str(), type.c_str()) == 0) {
+        s = s.substr(0, s.size() - len);
+        meta.labels.push_back(s);
+        meta.labelMap[s] = "NUMERIC";
+        return true;
+      }
     }
 
     {
-      int pos = s.find_last_of("{");
+      size_t pos = s.find_last_of("{");
+      VecS domain;
+      if (pos != s.npos) {
+        std::string values = s.substr(pos + 1, s.find_last_of("}") - pos - 1);
+        split(domain, values, boost::is_any_of(","));
+        trimWhiteSpaces(domain);
+      }
       s = s.substr(0, pos);
+      boost::trim(s);
       meta.labels.push_back(s);
       meta.labelMap[s] = "CATEGORICAL";
+      meta.domains[s] = domain;
       return true;
     }
     return true;
@@ -128,33 +246,98 @@ bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &
   return true;
 }
 
-bool DataReader::parseDataLine(const std::string &line, Data &data, MetaData &meta) {
-  std::vector<std::string> vec;
-  split(vec, line, boost::is_any_of(","));
-  trimWhiteSpaces(vec);
+bool DataReader::parseDataLine(std::string_view line, DataTable &data, const std::vector<size_t> &columns) {
+  line = trim(line);
+  if (line.empty() || line[0] == '%') {
+    return true;
+  }
 
-  if (classLabel_.empty()) {
-    data.emplace_back(std::move(vec));
-  } else {
-    moveClassDataToBack(vec, meta.labels);
-    data.emplace_back(std::move(vec));
+  if (line[0] == '{') {
+    return parseSparseLine(line, data, columns);
   }
 
-  return true;
+  //the cells are views into the line, reused across the lines of a thread
+  thread_local std::vector<std::string_view> cells;
+  cells.clear();
+  for (size_t position = 0; ; ) {
+    const size_t end = std::min(line.find(',', position), line.size());
+    cells.push_back(trim(line.substr(position, end - position)));
+    if (end == line.size())
+      break;
+    position = end + 1;
+  }
+  if (cells.size() != columns.size()) {
+    return false;
+  }
+
+  return appendRow(cells, data, columns);
 }
 
-void DataReader::moveClassLabelToBack() {
-  const auto result = std::find(std::begin(trainMetaData_.labels), std::end(trainMetaData_.labels), classLabel_);
-  if (result != std::end(metaData().labels))
-    std::iter_swap(result, std::end(trainMetaData_.labels)-1);
+/**
+ * Method that parses a row in the sparse ARFF format, e.g. {1 3.5, 4 red}:
+ * pairs of a 0-based attribute index and a value. The attributes that are
+ * left out are 0 when numeric and their first declared value when categorical.
+ *
+ * @param line - trimmed line that starts with '{'
+ * @param data - receives the row
+ * @param columns - column of every attribute in the data table
+ * @return - false when the row is malformed, it is then skipped
+ */
+bool DataReader::parseSparseLine(std::string_view line, DataTable &data, const std::vector<size_t> &columns) {
+  if (line.back() != '}') {
+    return false;
+  }
+  line = line.substr(1, line.size() - 2);
+
+  thread_local std::vector<std::string_view> cells;
+  thread_local std::vector<bool> given;
+  cells.assign(columns.size(), std::string_view());
+  given.assign(columns.size(), false);
+  for (size_t position = 0; position < line.size(); ) {
+    const size_t end = std::min(line.find(',', position), line.size());
+    const std::string_view entry = trim(line.substr(position, end - position));
+    position = end + 1;
+    if (entry.empty())
+      continue;
+
+    const size_t space = entry.find_first_of(" \t");
+    size_t index = 0;
+    const auto [last, error] = std::from_chars(entry.data(), entry.data() + std::min(space, entry.size()), index);
+    if (space == entry.npos || error != std::errc() || last != entry.data() + space || index >= columns.size()) {
+      return false;
+    }
+    cells[index] = trim(entry.substr(space));
+    given[index] = true;
+  }
+
+  //the dictionaries of a table start with the declared values, so the first one is the default
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (given[i])
+      continue;
+    const bool isClass = columns[i] == data.columns();
+    const VecS& values = isClass ? data.classNames() : data.dictionary(columns[i]);
+    cells[i] = (isClass || !data.isNumeric(columns[i])) && !values.empty() ? std::string_view(values.front()) : "0";
+  }
+
+  return appendRow(cells, data, columns);
 }
 
-void DataReader::moveClassDataToBack(VecS &line, const VecS &labels) const{
-  static const auto result = std::find(std::begin(labels), std::end(labels), classLabel_);
-  if (result != std::end(labels)) {
-    static const auto result_index = std::distance(std::begin(labels), result);
-    std::iter_swap(std::begin(line)+result_index, std::end(line)-1);
+/**
+ * Method that moves the class label to the back of the labels and returns,
+ * for every attribute in the file, its column in the data table. The class
+ * attribute is mapped to the last position, i.e. the number of feature columns.
+ */
+const std::vector<size_t> DataReader::moveClassLabelToBack(MetaData &meta, const std::string& classLabel) {
+  std::vector<size_t> columns(meta.labels.size());
+  std::iota(std::begin(columns), std::end(columns), 0);
+
+  const auto result = std::find(std::begin(meta.labels), std::end(meta.labels), classLabel);
+  if (!classLabel.empty() && result != std::end(meta.labels)) {
+    const auto result_index = std::distance(std::begin(meta.labels), result);
+    std::iter_swap(result, std::end(meta.labels)-1);
+    std::iter_swap(std::begin(columns)+result_index, std::end(columns)-1);
   }
+  return columns;
 }
 
 void DataReader::trimWhiteSpaces(VecS &line) {
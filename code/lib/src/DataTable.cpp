@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include "DataTable.hpp"
+#include "MappedFile.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+DataTable::DataTable() :
+    numericColumn_({}),
+    numeric_({}),
+    categorical_({}),
+    dictionaries_({}),
+    classes_({}),
+    classDictionary_(),
+    rows_(0),
+    skipped_(0),
+    mapping_(nullptr),
+    numericView_({}),
+    categoricalView_({}),
+    classesView_(nullptr),
+    nonZeroStarts_({}),
+    nonZeroColumns_({}) {}
+
+DataTable::DataTable(const MetaData& meta) : DataTable() {
+  const size_t features = meta.labels.empty() ? 0 : meta.labels.size() - 1;
+  numericColumn_.resize(features);
+  numeric_.resize(features);
+  categorical_.resize(features);
+  dictionaries_.resize(features);
+
+  //seeding the dictionaries with the declared values keeps the ids of train and test data aligned
+  auto seed = [&meta](const string& label, Dictionary& dictionary) {
+    if (const auto domain = meta.domains.find(label); domain != std::end(meta.domains))
+      for (const auto& value: domain->second)
+        dictionary.encode(value);
+  };
+
+  for (size_t column = 0; column < features; column++) {
+    const auto type = meta.labelMap.find(meta.labels[column]);
+    numericColumn_[column] = type != std::end(meta.labelMap) && type->second == "NUMERIC";
+    if (!numericColumn_[column])
+      seed(meta.labels[column], dictionaries_[column]);
+  }
+  if (!meta.labels.empty())
+    seed(meta.labels.back(), classDictionary_);
+  refreshViews();
+}
+
+DataTable::DataTable(const DataTable& other) :
+    numericColumn_(other.numericColumn_),
+    numeric_(other.numeric_),
+    categorical_(other.categorical_),
+    dictionaries_(other.dictionaries_),
+    classes_(other.classes_),
+    classDictionary_(other.classDictionary_),
+    rows_(other.rows_),
+    skipped_(other.skipped_),
+    mapping_(other.mapping_),
+    numericView_(other.numericView_),
+    categoricalView_(other.categoricalView_),
+    classesView_(other.classesView_),
+    nonZeroStarts_(other.nonZeroStarts_),
+    nonZeroColumns_(other.nonZeroColumns_) {
+  refreshViews();
+}
+
+DataTable& DataTable::operator=(const DataTable& other) {
+  if (this != &other) {
+    DataTable copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+void DataTable::append(size_t column, string_view cell) {
+  if (mapping_)
+    materialize();
+  nonZeroStarts_.clear();
+
+  if (numericColumn_[column]) {
+    numeric_[column].push_back(parseNumeric(cell));
+    numericView_[column] = numeric_[column].data();
+  } else {
+    categorical_[column].push_back(dictionaries_[column].encode(cell));
+    categoricalView_[column] = categorical_[column].data();
+  }
+}
+
+void DataTable::append(size_t column, float value) {
+  if (mapping_)
+    materialize();
+  nonZeroStarts_.clear();
+
+  numeric_[column].push_back(value);
+  numericView_[column] = numeric_[column].data();
+}
+
+void DataTable::appendClass(string_view cell) {
+  if (mapping_)
+    materialize();
+
+  classes_.push_back(classDictionary_.encode(cell));
+  classesView_ = classes_.data();
+  rows_ = classes_.size();
+}
+
+/**
+ * Method that appends all rows of another table with the same columns. Its
+ * categories are translated to the dictionaries of this table, new values are
+ * added in the order they first appear.
+ *
+ * @param rows - table to append
+ */
+void DataTable::append(const DataTable& rows) {
+  if (mapping_)
+    materialize();
+
+  auto extend = [](vector<Category>& ids, const vector<Category>& from, const vector<Category>& mapping) {
+    ids.reserve(ids.size() + from.size());
+    for (const auto id: from)
+      ids.push_back(mapping[id]);
+  };
+
+  for (size_t column = 0; column < columns(); column++) {
+    if (numericColumn_[column])
+      numeric_[column].insert(std::end(numeric_[column]), rows.numeric(column), rows.numeric(column) + rows.rows());
+    else
+      extend(categorical_[column], vector<Category>(rows.categories(column), rows.categories(column) + rows.rows()),
+             remap(rows.dictionaries_[column], dictionaries_[column]));
+  }
+  extend(classes_, vector<Category>(rows.classes(), rows.classes() + rows.rows()),
+         remap(rows.classDictionary_, classDictionary_));
+  rows_ = classes_.size();
+  skipped_ += rows.skipped_;
+  nonZeroStarts_.clear();
+  refreshViews();
+}
+
+/**
+ * Method that re-encodes the categorical columns and the class label with the
+ * dictionaries of another table, so ids can be compared across both tables.
+ * Values unknown to the reference get ids past the end of its dictionary.
+ *
+ * @param reference - table whose dictionaries are used (usually the training data)
+ */
+void DataTable::conform(const DataTable& reference) {
+  //ids that keep their value are left alone, so a mapped table is only copied when an id changes
+  auto recode = [this](vector<Category>& ids, const vector<Category>& mapping) {
+    for (Category id = 0; id < mapping.size(); id++) {
+      if (mapping[id] != id) {
+        if (mapping_)
+          materialize();
+        for (auto& value: ids)
+          value = mapping[value];
+        return;
+      }
+    }
+  };
+
+  for (size_t column = 0; column < columns() && column < reference.columns(); column++) {
+    if (numericColumn_[column])
+      continue;
+    Dictionary dictionary = reference.dictionaries_[column];
+    recode(categorical_[column], remap(dictionaries_[column], dictionary));
+    dictionaries_[column] = std::move(dictionary);
+  }
+
+  Dictionary dictionary = reference.classDictionary_;
+  recode(classes_, remap(classDictionary_, dictionary));
+  classDictionary_ = std::move(dictionary);
+  refreshViews();
+}
+
+DataTable DataTable::select(const vector<size_t>& rows) const {
+  DataTable selection;
+  selection.numericColumn_ = numericColumn_;
+  selection.numeric_.resize(columns());
+  selection.categorical_.resize(columns());
+  selection.dictionaries_ = dictionaries_;
+  selection.classDictionary_ = classDictionary_;
+
+  for (size_t column = 0; column < columns(); column++) {
+    for (const auto row: rows) {
+      if (numericColumn_[column])
+        selection.numeric_[column].push_back(numericView_[column][row]);
+      else
+        selection.categorical_[column].push_back(categoricalView_[column][row]);
+    }
+  }
+  for (const auto row: rows)
+    selection.classes_.push_back(classesView_[row]);
+  selection.rows_ = rows.size();
+  selection.refreshViews();
+  return selection;
+}
+
+/**
+ * Method that describes the columns of this table, with the dictionaries as
+ * the declared domains. A table created from it encodes categories with the
+ * same ids as this one, so it can serve as the reference of conform() once
+ * the rows are gone, e.g. in a process that only loads a saved model.
+ *
+ * @param meta - meta data the table was read with
+ */
+MetaData DataTable::schema(const MetaData& meta) const {
+  MetaData schema = meta;
+  for (size_t column = 0; column < columns() && column < meta.labels.size(); column++) {
+    if (!numericColumn_[column])
+      schema.domains[meta.labels[column]] = dictionaries_[column].values;
+  }
+  if (!meta.labels.empty())
+    schema.domains[meta.labels.back()] = classDictionary_.values;
+  return schema;
+}
+
+/**
+ * Method that indexes the numeric values that are not 0 by row, when they are
+ * few enough that visiting only them pays off. Otherwise the table is left
+ * without index. Missing values count as non-zero.
+ */
+void DataTable::indexSparse() {
+  nonZeroStarts_.clear();
+  nonZeroColumns_.clear();
+
+  size_t cells = 0, nonZeros = 0;
+  for (size_t column = 0; column < columns(); column++) {
+    if (!numericColumn_[column])
+      continue;
+    cells += rows_;
+    nonZeros += std::count_if(numericView_[column], numericView_[column] + rows_, [](float value) { return value != 0; });
+  }
+  if (cells == 0 || nonZeros > sparseDensity * cells)
+    return;
+
+  //counting the entries per row, then filling them column by column keeps the columns of a row increasing
+  vector<size_t> starts(rows_ + 1, 0);
+  for (size_t column = 0; column < columns(); column++) {
+    if (numericColumn_[column])
+      for (size_t row = 0; row < rows_; row++)
+        starts[row + 1] += numericView_[column][row] != 0;
+  }
+  std::partial_sum(starts.begin(), starts.end(), starts.begin());
+
+  vector<size_t> next(starts.begin(), starts.end() - 1);
+  nonZeroColumns_.resize(nonZeros);
+  for (size_t column = 0; column < columns(); column++) {
+    if (numericColumn_[column])
+      for (size_t row = 0; row < rows_; row++)
+        if (numericView_[column][row] != 0)
+          nonZeroColumns_[next[row]++] = static_cast<uint32_t>(column);
+  }
+  nonZeroStarts_ = std::move(starts);
+}
+
+/**
+ * Method that copies the columns of a mapped table into vectors of its own, so
+ * the table can be modified.
+ */
+void DataTable::materialize() {
+  for (size_t column = 0; column < columns(); column++) {
+    if (numericColumn_[column])
+      numeric_[column].assign(numericView_[column], numericView_[column] + rows_);
+    else
+      categorical_[column].assign(categoricalView_[column], categoricalView_[column] + rows_);
+  }
+  classes_.assign(classesView_, classesView_ + rows_);
+  mapping_.reset();
+  refreshViews();
+}
+
+/**
+ * Method that points the column views at the vectors of the table, unless its
+ * columns live in a mapped file.
+ */
+void DataTable::refreshViews() {
+  if (mapping_)
+    return;
+
+  numericView_.resize(columns());
+  categoricalView_.resize(columns());
+  for (size_t column = 0; column < columns(); column++) {
+    numericView_[column] = numeric_[column].data();
+    categoricalView_[column] = categorical_[column].data();
+  }
+  classesView_ = classes_.data();
+}
+
+Category DataTable::Dictionary::encode(string_view value) {
+  const size_t hash = std::hash<string_view>()(value);
+  for (auto [found, last] = ids.equal_range(hash); found != last; ++found) {
+    if (values[found->second] == value)
+      return found->second;
+  }
+
+  const auto id = static_cast<Category>(values.size());
+  values.emplace_back(value);
+  ids.emplace(hash, id);
+  return id;
+}
+
+/**
+ * Method that parses a numeric cell. Missing values ('?') and NaN are mapped
+ * to minus infinity, so they always end up in the false branch of a numeric
+ * question. The cell is read as a double, with an optional leading '+', and
+ * rounded to float; values beyond the range of a double saturate to infinity
+ * or 0, as with std::stod before.
+ */
+bool DataTable::parseNumeric(string_view cell, float& value) {
+  if (cell == "?") {
+    value = -std::numeric_limits<float>::infinity();
+    return true;
+  }
+  if (cell.size() > 1 && cell[0] == '+' && cell[1] != '-')
+    cell.remove_prefix(1);
+
+  double number = 0;
+  const auto [end, error] = std::from_chars(cell.data(), cell.data() + cell.size(), number);
+  if (end != cell.data() + cell.size() || (error != std::errc() && error != std::errc::result_out_of_range))
+    return false;
+  if (error == std::errc::result_out_of_range)
+    number = std::strtod(string(cell).c_str(), nullptr); //infinity or (almost) 0 with the sign of the cell
+
+  value = std::isnan(number) ? -std::numeric_limits<float>::infinity() : static_cast<float>(number);
+  return true;
+}
+
+float DataTable::parseNumeric(string_view cell) {
+  float value = 0;
+  if (!parseNumeric(cell, value))
+    throw std::invalid_argument("Not a numeric value: " + string(cell));
+  return value;
+}
+
+vector<Category> DataTable::remap(const Dictionary& from, Dictionary& to) {
+  vector<Category> mapping;
+  mapping.reserve(from.values.size());
+  for (const auto& value: from.values)
+    mapping.push_back(to.encode(value));
+  return mapping;
+}
@@ -5,72 +5,595 @@
  */
 
 #include "DecisionTree.hpp"
+#include <functional>
 #include <future>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include "CodeGenerator.hpp"
+#include "CostComplexity.hpp"
+#include "ModelFile.hpp"
+#include "OutOfCore.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
 
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
-using boost::timer::cpu_timer;
 
-DecisionTree::DecisionTree(DataReader* dr) : root_(Node()), dr_(dr) {
-  std::cout << "Start building tree." << std::endl; cpu_timer timer;
-  root_ = buildTree(dr_->trainData(), dr_->metaData(), createIndexes(dr->trainData()));
-  std::cout << "Done. " << timer.format() << std::endl;
+namespace {
+
+/**
+ * Rows of a node for the exact splitter: a range of the index buffer of the
+ * tree, sorted on every column each time the node is split.
+ */
+struct ExactRows {
+  size_t* begin;
+  size_t* end;
+  const int* weights; // nullptr when every row counts once
+
+  size_t size() const { return end - begin; }
+
+  std::tuple<const double, const Question> find_best_split(const DataTable& rows, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) const {
+    return Calculations::find_best_split(rows, IndexRange(begin, end), weights, columns, minLeaf, pool);
+  }
+
+  const std::vector<int> classCounts(const DataTable& rows) const {
+    return Calculations::classCounts(rows, IndexRange(begin, end), weights);
+  }
+
+  std::tuple<ExactRows, ExactRows> partition(const DataTable& rows, const Question& q) const {
+    size_t* middle = Calculations::partition(rows, q, begin, end);
+    return {ExactRows{begin, middle, weights}, ExactRows{middle, end, weights}};
+  }
+};
+
+/**
+ * Rows of a node for the presorted splitter: the same range of every column of
+ * the presorted buffer of the tree, kept in sorted order through every
+ * partition.
+ */
+struct PresortedRows {
+  SortedIndexes* sorted;
+  size_t begin;
+  size_t end;
+  const int* weights;
+
+  size_t size() const { return end - begin; }
+
+  std::tuple<const double, const Question> find_best_split(const DataTable& rows, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) const {
+    return Calculations::find_best_split(rows, *sorted, begin, end, weights, columns, minLeaf, pool);
+  }
+
+  const std::vector<int> classCounts(const DataTable& rows) const {
+    if (sorted->empty())
+      return std::vector<int>(rows.numClasses(), 0);
+    return Calculations::classCounts(rows, IndexRange(sorted->front().data() + begin, sorted->front().data() + end), weights);
+  }
+
+  std::tuple<PresortedRows, PresortedRows> partition(const DataTable& rows, const Question& q) const {
+    const size_t middle = Calculations::partition(rows, q, *sorted, begin, end);
+    return {PresortedRows{sorted, begin, middle, weights}, PresortedRows{sorted, middle, end, weights}};
+  }
+};
+
+/**
+ * Rows of a node for the histogram splitter: a range of the index buffer of
+ * the tree and the class counts per bin of its rows. Only the smaller child
+ * builds its histogram from its rows, the larger one is the parent minus its
+ * sibling.
+ */
+struct HistogramRows {
+  const Binning* binning;
+  size_t* begin;
+  size_t* end;
+  const int* weights;
+  Histogram histogram;
+
+  HistogramRows() : binning(nullptr), begin(nullptr), end(nullptr), weights(nullptr), histogram() {}
+
+  HistogramRows(const Binning* binning, size_t* begin, size_t* end, const int* weights, Histogram histogram) :
+      binning(binning), begin(begin), end(end), weights(weights), histogram(std::move(histogram)) {}
+
+  HistogramRows(const DataTable& rows, const Binning& binning, size_t* begin, size_t* end, const int* weights) :
+      binning(&binning), begin(begin), end(end), weights(weights), histogram(binning, rows.numClasses()) {
+    histogram.add(rows, binning, IndexRange(begin, end), weights);
+  }
+
+  //the histogram is moved from parent to child, never copied
+  HistogramRows(const HistogramRows&) = delete;
+  HistogramRows& operator=(const HistogramRows&) = delete;
+  HistogramRows(HistogramRows&&) = default;
+  HistogramRows& operator=(HistogramRows&&) = default;
+
+  size_t size() const { return end - begin; }
+
+  std::tuple<const double, const Question> find_best_split(const DataTable& rows, const std::vector<size_t>& columns, size_t minLeaf, ThreadPool* pool) const {
+    return Calculations::find_best_split(rows, *binning, histogram, columns, minLeaf, pool);
+  }
+
+  const std::vector<int> classCounts(const DataTable& rows) const {
+    return Calculations::classCounts(rows, IndexRange(begin, end), weights);
+  }
+
+  std::tuple<HistogramRows, HistogramRows> partition(const DataTable& rows, const Question& q) {
+    size_t* middle = Calculations::partition(rows, q, begin, end);
+
+    if (middle - begin < end - middle) {
+      HistogramRows smaller(rows, *binning, begin, middle, weights);
+      HistogramRows larger(binning, middle, end, weights, std::move(histogram));
+      larger.histogram.subtract(smaller.histogram);
+      return {std::move(smaller), std::move(larger)};
+    }
+
+    HistogramRows smaller(rows, *binning, middle, end, weights);
+    HistogramRows larger(binning, begin, middle, weights, std::move(histogram));
+    larger.histogram.subtract(smaller.histogram);
+    return {std::move(larger), std::move(smaller)};
+  }
+};
+
+/**
+ * SplitMix64 finalizer: a cheap 64-bit hash with good mixing, used to derive
+ * the random stream of a node from the seed of the tree and the node's path.
+ */
+inline uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * Random number generator of one node, seeded with mix().
+ */
+struct NodeRandom {
+  using result_type = uint64_t;
+  uint64_t state;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+  result_type operator()() { return mix(state++); }
+};
+
+} // namespace
+
+DecisionTree::DecisionTree(DataReader* dr, const TreeOptions& options) : arena_(), root_(0), dr_(dr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(), schema_(nullptr) {
+  train(createIndexes(dr->trainData()), nullptr);
+}
+
+DecisionTree::DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const TreeOptions& options) :
+    arena_(), root_(0), dr_(dr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(), schema_(nullptr) {
+  train(samples, nullptr);
+}
+
+DecisionTree::DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const Weights& weights, const TreeOptions& options) :
+    arena_(), root_(0), dr_(dr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(), schema_(nullptr) {
+  train(samples, weights.data());
+}
+
+DecisionTree::DecisionTree(DataReader* dr, SortedIndexes sorted, const Weights& weights, const TreeOptions& options) :
+    arena_(), root_(0), dr_(dr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(), schema_(nullptr) {
+  train(PresortedRows{&sorted, 0, sorted.empty() ? 0 : sorted.front().size(), weights.data()});
 }
 
-DecisionTree::DecisionTree(DataReader* dr, const std::vector<size_t>& samples) : root_(Node()), dr_(dr) {
-    std::cout << "Start building tree." << std::endl; cpu_timer timer;
-    root_ = buildTree(dr_->trainData(), dr_->metaData(), samples);
-    std::cout << "Done. " << timer.format() << std::endl;
+DecisionTree::DecisionTree(DataReader* dr, const std::vector<size_t>& samples, const Weights& weights, const Binning& binning, const TreeOptions& options) :
+    arena_(), root_(0), dr_(dr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(), schema_(nullptr) {
+  std::vector<size_t> indexes = samples;
+  train(HistogramRows(dr_->trainData(), binning, indexes.data(), indexes.data() + indexes.size(), weights.data()));
 }
 
-const Node DecisionTree::buildTree(const Data& rows, const MetaData& meta, const std::vector<size_t>& indexes) {
-    auto const& [gain, question] = Calculations::find_best_split(rows,meta,indexes);
+DecisionTree::DecisionTree(FlatTree flat, std::shared_ptr<const MetaData> schema, const TreeOptions& options) :
+    arena_(), root_(0), dr_(nullptr), options_(options), pool_(nullptr), predictionPool_(options.pool), columns_({}), features_(0), rootSize_(0), flat_(std::move(flat)), schema_(std::move(schema)) {}
+
+/**
+ * Method that trains the tree with the split strategy of the options. The
+ * samples are the index buffer of the tree (one list per column for the
+ * presorted splitter): every node owns a range of it, which is partitioned in
+ * place between its children, so building the tree allocates no index lists.
+ *
+ * @param samples - rows of the root
+ * @param weights - weight of every row of the data set, or nullptr when every row counts once
+ */
+void DecisionTree::train(std::vector<size_t> samples, const int* weights) {
+  const DataTable& rows = dr_->trainData();
+  Profiler* profiler = options_.profiler.get();
+  switch (options_.splitter) {
+    case Splitter::Presorted: {
+      SortedIndexes sorted = Profiler::measure(profiler, "sort", samples.size(), [&]() { return Calculations::presort(rows, samples); });
+      train(PresortedRows{&sorted, 0, samples.size(), weights});
+      break;
+    }
+    case Splitter::Histogram: {
+      const Binning binning = Profiler::measure(profiler, "sort", rows.rows(), [&]() { return Binning(rows); });
+      train(HistogramRows(rows, binning, samples.data(), samples.data() + samples.size(), weights));
+      break;
+    }
+    default:
+      train(ExactRows{samples.data(), samples.data() + samples.size(), weights});
+  }
+}
+
+/**
+ * Method that builds the tree from the rows of the root, on the pool of the
+ * options or on a pool of its own.
+ */
+template <typename Rows>
+void DecisionTree::train(Rows root) {
+  Profiler::Scope scope(options_.profiler.get(), "tree", root.size(), true);
+
+  std::shared_ptr<ThreadPool> pool = options_.pool;
+  if (!pool && options_.threads != 1)
+    pool = std::make_shared<ThreadPool>(options_.threads);
+
+  pool_ = pool.get();
+  arena_ = NodeArena(dr_->trainData().numClasses());
+  columns_ = Calculations::allColumns(dr_->trainData());
+  features_ = options_.featuresPerSplit(columns_.size());
+  const std::vector<int> counts = root.classCounts(dr_->trainData());
+  rootSize_ = std::accumulate(counts.begin(), counts.end(), 0.0);
+  if (options_.maxLeafNodes > 0)
+    root_ = buildBestFirst(dr_->trainData(), std::move(root));
+  else
+    root_ = buildTree(dr_->trainData(), std::move(root), 1, 0);
+  pool_ = nullptr;
+  options_.pool.reset(); //training is done, the pool is kept for predictions only
+  predictionPool_ = std::move(pool);
+  flat_ = FlatTree(arena_, root_);
+}
+
+/**
+ * Method that searches the best split of a node, unless the pre-pruning limits
+ * of the options make it a leaf.
+ *
+ * @param rows - data set
+ * @param node - rows of the node
+ * @param counts - class counts of the node
+ * @param path - identifies the node within the tree, see buildTree
+ * @param depth - depth of the node, 0 for the root
+ * @param pool - pool to evaluate the columns on, or nullptr
+ * @return - gain of the split, 0 when the node is a leaf, and its question
+ */
+template <typename Rows>
+std::tuple<double, Question> DecisionTree::findSplit(const DataTable& rows, const Rows& node, const std::vector<int>& counts, uint64_t path, size_t depth, ThreadPool* pool) const {
+    const double size = std::accumulate(counts.begin(), counts.end(), 0.0);
+    if ((options_.maxDepth > 0 && depth >= options_.maxDepth) || size < options_.minSamplesSplit || size < 2.0 * options_.minSamplesLeaf) {
+        return {0.0, Question()};
+    }
+
+    //with max features, the node only evaluates a random subset of the columns
+    const std::vector<size_t> drawn = features_ < columns_.size() ? drawColumns(path) : std::vector<size_t>();
+    const std::vector<size_t>& columns = drawn.empty() ? columns_ : drawn;
+    auto const& [gain, question] = Profiler::measure(options_.profiler.get(), "threshold scan", node.size(), [&]() {
+        return node.find_best_split(rows, columns, options_.minSamplesLeaf, pool);
+    });
+
+    //the decrease of the impurity of the whole tree is the gain weighted by the share of the training rows in the node
+    if (gain * size / rootSize_ < options_.minImpurityDecrease) {
+        return {0.0, Question()};
+    }
+    return std::make_tuple(gain, question);
+}
+
+/**
+ * Method that recursively builds the tree, independent of how the rows of a
+ * node are represented by the split strategy.
+ *
+ * @param rows - data set
+ * @param node - rows of the current node (ExactRows, PresortedRows or HistogramRows)
+ * @param path - identifies the node within the tree: 1 for the root, derived from the parent for the children
+ * @param depth - depth of the node, 0 for the root
+ * @return - index of the root of the subtree in arena_
+ */
+template <typename Rows>
+uint32_t DecisionTree::buildTree(const DataTable& rows, Rows node, uint64_t path, size_t depth) {
+    //large nodes (near the root) can also spread their columns over the pool
+    const bool parallel = pool_ != nullptr && node.size() >= options_.parallelCutoff;
+    Profiler* profiler = options_.profiler.get();
+    const std::vector<int> counts = Profiler::measure(profiler, "class counts", node.size(), [&]() { return node.classCounts(rows); });
+    if (profiler)
+        profiler->node(depth, std::accumulate(counts.begin(), counts.end(), 0.0));
+    //named variables rather than a structured binding, which the lambdas below could not capture
+    double gain = 0;
+    Question question;
+    std::tie(gain, question) = findSplit(rows, node, counts, path, depth, parallel && options_.parallelFeatures ? pool_ : nullptr);
 
     if (gain == 0) {
-        return Node(Leaf(Calculations::classCounts(rows, indexes)));
+        return Profiler::measure(profiler, "node allocation", 0, [&]() { return arena_.addLeaf(counts); });
     }
 
-    //partitioning the data indexes, instead of the data
-    const auto partitions{Calculations::partition(rows, question, indexes)} ;
-    const std::vector<size_t>& true_branch{ std::get<0>(partitions) };
-    const std::vector<size_t>& false_branch{ std::get<1>(partitions) };
+    //partitioning the range of data indexes in place, instead of the data. The rows of the parent are no longer needed.
+    auto [true_branch, false_branch] = Profiler::measure(profiler, "partition", node.size(), [&]() { return node.partition(rows, question); });
+    node = Rows();
+
+    const uint64_t true_path = mix(2 * path);
+    const uint64_t false_path = mix(2 * path + 1);
+
+    //small subtrees are cheaper to build sequentially than to schedule
+    if (!parallel) {
+        const uint32_t left_node = buildTree(rows, std::move(true_branch), true_path, depth + 1);
+        const uint32_t right_node = buildTree(rows, std::move(false_branch), false_path, depth + 1);
+        return Profiler::measure(profiler, "node allocation", 0, [&]() { return arena_.addSplit(question, left_node, right_node); });
+    }
+
+    //the true branch is offered to the pool (an idle worker steals it), this thread builds the false branch
+    std::future<uint32_t> future{pool_->submit([this, &rows, branch = std::move(true_branch), true_path, depth]() mutable {
+        return buildTree(rows, std::move(branch), true_path, depth + 1);
+    })};
+    const uint32_t right_node = buildTree(rows, std::move(false_branch), false_path, depth + 1);
+    const uint32_t left_node = pool_->wait(future);
+
+    return Profiler::measure(profiler, "node allocation", 0, [&]() { return arena_.addSplit(question, left_node, right_node); });
+}
+
+/**
+ * Method that builds the tree best first, to respect options.maxLeafNodes: of
+ * all nodes that can be split, the one whose split decreases the impurity of
+ * the tree most (gain times rows) is split first, until the tree has
+ * maxLeafNodes leaves. Ties go to the node that was found first. Without the
+ * limit, the result is the same tree as buildTree's.
+ *
+ * @param rows - data set
+ * @param root - rows of the root
+ * @return - index of the root in arena_
+ */
+template <typename Rows>
+uint32_t DecisionTree::buildBestFirst(const DataTable& rows, Rows root) {
+    struct Candidate {
+        Rows rows;
+        uint64_t path;
+        size_t depth;
+        std::vector<int> counts;
+        double gain;
+        Question question;
+        double priority; // gain times the rows of the node
+        bool split;
+        size_t trueChild;
+        size_t falseChild;
+    };
+    std::vector<Candidate> nodes;
+    Profiler* profiler = options_.profiler.get();
+
+    auto evaluate = [&](Rows node, uint64_t path, size_t depth) {
+        const bool parallel = pool_ != nullptr && options_.parallelFeatures && node.size() >= options_.parallelCutoff;
+        std::vector<int> counts = Profiler::measure(profiler, "class counts", node.size(), [&]() { return node.classCounts(rows); });
+        if (profiler)
+            profiler->node(depth, std::accumulate(counts.begin(), counts.end(), 0.0));
+        auto [gain, question] = findSplit(rows, node, counts, path, depth, parallel ? pool_ : nullptr);
+        const double priority = gain * std::accumulate(counts.begin(), counts.end(), 0.0);
+        nodes.push_back(Candidate{std::move(node), path, depth, std::move(counts), gain, question, priority, false, 0, 0});
+        return nodes.size() - 1;
+    };
+
+    auto lower = [&nodes](size_t a, size_t b) {
+        return nodes[a].priority < nodes[b].priority || (nodes[a].priority == nodes[b].priority && a > b);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(lower)> open(lower);
+
+    if (const size_t first = evaluate(std::move(root), 1, 0); nodes[first].gain > 0)
+        open.push(first);
 
-    //starting two different async calls that are going to build tree in parallel
-    std::future<const Node> future1{std::async(&DecisionTree::buildTree, this, std::cref(rows), std::cref(meta), std::cref(true_branch))};
-    std::future<const Node> future2{std::async(&DecisionTree::buildTree, this, std::cref(rows), std::cref(meta), std::cref(false_branch))};
+    for (size_t leaves = 1; !open.empty() && leaves < options_.maxLeafNodes; leaves++) {
+        const size_t id = open.top();
+        open.pop();
 
-    Node left_node { future1.get() };
-    Node right_node { future2.get() };
+        auto [true_branch, false_branch] = Profiler::measure(profiler, "partition", nodes[id].rows.size(), [&]() {
+            return nodes[id].rows.partition(rows, nodes[id].question);
+        });
+        nodes[id].rows = Rows();
+        nodes[id].split = true;
+        const uint64_t path = nodes[id].path;
+        const size_t depth = nodes[id].depth;
 
-    return Node(left_node, right_node, question);
+        const size_t true_child = evaluate(std::move(true_branch), mix(2 * path), depth + 1);
+        const size_t false_child = evaluate(std::move(false_branch), mix(2 * path + 1), depth + 1);
+        nodes[id].trueChild = true_child;
+        nodes[id].falseChild = false_child;
+        for (const size_t child: {true_child, false_child})
+            if (nodes[child].gain > 0)
+                open.push(child);
+    }
+
+    //the nodes are stored children first
+    std::function<uint32_t(size_t)> store = [&](size_t id) -> uint32_t {
+        if (!nodes[id].split)
+            return Profiler::measure(profiler, "node allocation", 0, [&]() { return arena_.addLeaf(nodes[id].counts); });
+        const uint32_t left_node = store(nodes[id].trueChild);
+        const uint32_t right_node = store(nodes[id].falseChild);
+        return Profiler::measure(profiler, "node allocation", 0, [&]() { return arena_.addSplit(nodes[id].question, left_node, right_node); });
+    };
+    return store(0);
+}
+
+/**
+ * Method that draws the columns a node evaluates when max features is set. The
+ * draw only depends on the seed of the options and the path of the node, so
+ * the tree is the same however its subtrees are scheduled.
+ *
+ * @param path - path of the node, see buildTree
+ * @return - features_ distinct columns, in increasing order
+ */
+const std::vector<size_t> DecisionTree::drawColumns(uint64_t path) const {
+  NodeRandom random{mix(options_.seed ^ mix(path))};
+  std::vector<size_t> columns = columns_;
+
+  //partial Fisher-Yates shuffle: the first features_ columns are a uniform draw
+  for (size_t i = 0; i < features_; i++) {
+    std::uniform_int_distribution<size_t> distribution(i, columns.size() - 1);
+    std::swap(columns[i], columns[distribution(random)]);
+  }
+  columns.resize(features_);
+  std::sort(columns.begin(), columns.end());
+  return columns;
 }
 
 void DecisionTree::print() const {
-  print(make_shared<Node>(root_));
+  if (!dr_)
+    throw std::logic_error("A restored tree can only predict");
+  print(root_);
 }
 
-void DecisionTree::print(const shared_ptr<Node> root, string spacing) const {
-  if (bool is_leaf = root->leaf() != nullptr; is_leaf) {
-    const auto &leaf = root->leaf();
-    std::cout << spacing + "Predict: "; Utils::print::print_map(leaf->predictions());
+void DecisionTree::print(uint32_t index, string spacing) const {
+  const ArenaNode& node = arena_.node(index);
+  if (bool is_leaf = node.leaf >= 0; is_leaf) {
+    const int* counts = arena_.counts(node);
+    const VecS& classNames = dr_->trainData().classNames();
+    std::unordered_map<string, int> predictions;
+    for (size_t k = 0; k < arena_.numClasses(); k++)
+      if (counts[k] > 0)
+        predictions[classNames[k]] = counts[k];
+    std::cout << spacing + "Predict: "; Utils::print::print_map(predictions);
     return;
   }
-  std::cout << spacing << root->question().toString(dr_->metaData().labels) << "\n";
+  std::cout << spacing << node.question.toString(dr_->metaData().labels, dr_->trainData()) << "\n";
 
   std::cout << spacing << "--> True: " << "\n";
-  print(root->trueBranch(), spacing + "   ");
+  print(node.trueChild, spacing + "   ");
 
   std::cout << spacing << "--> False: " << "\n";
-  print(root->falseBranch(), spacing + "   ");
+  print(node.falseChild, spacing + "   ");
 }
 
 void DecisionTree::test() const {
-  TreeTest t(dr_->testData(), dr_->metaData(), root_);
+  if (!dr_)
+    throw std::logic_error("A restored tree can only predict");
+  const DataTable& testData = dr_->testData();
+  std::vector<Category> predictions(testData.rows());
+  predict(testData, predictions.data());
+  TreeTest t(testData, predictions);
+}
+
+/**
+ * Method that returns the alphas at which the pruned tree changes, see
+ * CostComplexity.
+ *
+ * @return - distinct pruning alphas, increasing
+ */
+std::vector<double> DecisionTree::pruningPath() const {
+  if (!dr_)
+    throw std::logic_error("A restored tree can only predict");
+  return CostComplexity(arena_, root_).path();
+}
+
+/**
+ * Method that replaces the tree by its subtree of minimal cost-complexity: the
+ * subtrees whose pruning alpha is at most alpha are collapsed into leaves.
+ *
+ * @param alpha - complexity parameter, e.g. one of pruningPath()
+ */
+void DecisionTree::prune(double alpha) {
+  if (!dr_)
+    throw std::logic_error("A restored tree can only predict");
+  NodeArena pruned(arena_.numClasses());
+  root_ = CostComplexity(arena_, root_).prune(alpha, pruned);
+  arena_ = std::move(pruned);
+  flat_ = FlatTree(arena_, root_);
+}
+
+/**
+ * Method that prunes the tree with the alpha of the pruning path that
+ * classifies held-out rows best, e.g. a validation set or the out-of-bag rows
+ * of a bagged tree.
+ *
+ * @param data - data set, encoded with the dictionaries of the training data
+ * @param rows - held-out rows of the data set
+ * @return - the chosen alpha
+ */
+double DecisionTree::prune(const DataTable& data, IndexRange rows) {
+  if (!dr_)
+    throw std::logic_error("A restored tree can only predict");
+  const double alpha = CostComplexity(arena_, root_).select(data, rows);
+  prune(alpha);
+  return alpha;
+}
+
+double DecisionTree::prune(const DataTable& data) {
+  return prune(data, createIndexes(data));
+}
+
+MetaData DecisionTree::schema() const {
+  return schema_ ? *schema_ : dr_->trainData().schema(dr_->metaData());
+}
+
+/**
+ * Method that trains a tree on an ARFF file without loading it in memory, see
+ * OutOfCore. Like a restored tree, the result has no data reader and is used
+ * through predict(), save() and generateCode().
+ *
+ * @param filename - path of the ARFF file
+ * @param classLabel - label of the class attribute
+ * @param options - threads and memory budget, the splits are always found on histograms
+ * @return - the trained tree
+ */
+DecisionTree DecisionTree::trainOutOfCore(const std::string& filename, const std::string& classLabel, const TreeOptions& options) {
+  OutOfCore::Result result = OutOfCore::train(filename, classLabel, options);
+
+  DecisionTree tree(FlatTree(result.tree, result.root), std::make_shared<const MetaData>(std::move(result.schema)), options);
+  tree.arena_ = std::move(result.tree);
+  tree.root_ = result.root;
+  return tree;
+}
+
+/**
+ * Method that saves the tree to a model file, see ModelFile.
+ *
+ * @param filename - path of the model file
+ */
+void DecisionTree::save(const std::string& filename) const {
+  ModelFile::save(filename, schema(), {&flat_});
+}
+
+/**
+ * Method that writes the tree as a standalone C++ source, see CodeGenerator.
+ *
+ * @param filename - path of the source file
+ */
+void DecisionTree::generateCode(const std::string& filename) const {
+  CodeGenerator::generate(filename, {&flat_}, schema());
+}
+
+/**
+ * Method that loads a tree saved with save(). The tree is mapped from the file
+ * and can only be used for prediction; data to classify must be encoded with
+ * the dictionaries of schema(), e.g. by conforming it to DataTable(schema()).
+ *
+ * @param filename - path of the model file
+ * @param options - options used for prediction (threads)
+ * @return - the restored tree
+ */
+DecisionTree DecisionTree::load(const std::string& filename, const TreeOptions& options) {
+  MetaData schema;
+  std::vector<FlatTree> trees = ModelFile::load(filename, schema);
+  if (trees.size() != 1)
+    throw std::runtime_error("Not a single tree: " + filename);
+  return DecisionTree(std::move(trees.front()), std::make_shared<const MetaData>(std::move(schema)), options);
+}
+
+void DecisionTree::predict(const DataTable& data, size_t begin, size_t end, Category* out) const {
+  Profiler::Scope scope(options_.profiler.get(), "predict", end - begin);
+  parallelFor(predictionPool_, options_.threads, begin, end, predictionGrain, [&](size_t chunk, size_t chunkEnd) {
+    flat_.predict(data, chunk, chunkEnd, out + (chunk - begin));
+  });
+}
+
+void DecisionTree::predict(const DataTable& data, Category* out) const {
+  predict(data, 0, data.rows(), out);
+}
+
+void DecisionTree::predictProba(const DataTable& data, size_t begin, size_t end, float* out) const {
+  Profiler::Scope scope(options_.profiler.get(), "predict", end - begin);
+  parallelFor(predictionPool_, options_.threads, begin, end, predictionGrain, [&](size_t chunk, size_t chunkEnd) {
+    flat_.predictProba(data, chunk, chunkEnd, out + (chunk - begin) * flat_.numClasses());
+  });
+}
+
+void DecisionTree::predictProba(const DataTable& data, float* out) const {
+  predictProba(data, 0, data.rows(), out);
 }
 
-const std::vector<size_t> DecisionTree::createIndexes(const Data& data) {
-    std::vector<size_t> indexes(data.size());
+const std::vector<size_t> DecisionTree::createIndexes(const DataTable& data) {
+    std::vector<size_t> indexes(data.rows());
     std::iota(indexes.begin(), indexes.end(), 0);
     return indexes;
 }
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "FlatTree.hpp"
+#include "MappedFile.hpp"
+
+FlatTree::FlatTree() :
+    nodes_({}),
+    classes_({}),
+    probabilities_({}),
+    categories_({}),
+    numClasses_(0),
+    mapping_(nullptr),
+    nodesView_(nullptr),
+    classesView_(nullptr),
+    probabilitiesView_(nullptr),
+    categoriesView_(nullptr),
+    size_(0),
+    leaves_(0),
+    categoryWords_(0) {}
+
+FlatTree::FlatTree(const NodeArena& arena, uint32_t root) : FlatTree() {
+  numClasses_ = arena.numClasses();
+  nodes_.reserve(arena.size());
+  add(arena, root);
+  refreshViews();
+}
+
+FlatTree::FlatTree(const FlatTree& other) :
+    nodes_(other.nodes_),
+    classes_(other.classes_),
+    probabilities_(other.probabilities_),
+    categories_(other.categories_),
+    numClasses_(other.numClasses_),
+    mapping_(other.mapping_),
+    nodesView_(other.nodesView_),
+    classesView_(other.classesView_),
+    probabilitiesView_(other.probabilitiesView_),
+    categoriesView_(other.categoriesView_),
+    size_(other.size_),
+    leaves_(other.leaves_),
+    categoryWords_(other.categoryWords_) {
+  refreshViews();
+}
+
+FlatTree& FlatTree::operator=(const FlatTree& other) {
+  if (this != &other) {
+    FlatTree copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+/**
+ * Method that points the views at the vectors of the tree, unless its arrays
+ * live in a mapped file.
+ */
+void FlatTree::refreshViews() {
+  if (mapping_)
+    return;
+
+  nodesView_ = nodes_.data();
+  classesView_ = classes_.data();
+  probabilitiesView_ = probabilities_.data();
+  categoriesView_ = categories_.data();
+  size_ = nodes_.size();
+  leaves_ = classes_.size();
+  categoryWords_ = categories_.size();
+}
+
+/**
+ * Method that predicts the class of a range of rows.
+ *
+ * @param data - rows to classify
+ * @param begin, end - range of rows
+ * @param out - receives end - begin class ids
+ */
+void FlatTree::predict(const DataTable& data, size_t begin, size_t end, Category* out) const {
+  traverse(data, begin, end, [&](size_t row, uint32_t leaf) { out[row - begin] = classesView_[leaf]; });
+}
+
+/**
+ * Method that predicts the class probabilities of a range of rows.
+ *
+ * @param data - rows to classify
+ * @param begin, end - range of rows
+ * @param out - receives numClasses() probabilities per row, row after row
+ */
+void FlatTree::predictProba(const DataTable& data, size_t begin, size_t end, float* out) const {
+  traverse(data, begin, end, [&](size_t row, uint32_t leaf) {
+    std::copy_n(probabilitiesView_ + leaf * numClasses_, numClasses_, out + (row - begin) * numClasses_);
+  });
+}
+
+/**
+ * Method that appends a subtree in depth-first order.
+ *
+ * @param arena - nodes of the tree
+ * @param id - index of the root of the subtree in the arena
+ */
+void FlatTree::add(const NodeArena& arena, uint32_t id) {
+  const ArenaNode& node = arena.node(id);
+  const size_t index = nodes_.size();
+  nodes_.push_back(FlatNode());
+
+  if (node.leaf >= 0) {
+    const int* counts = arena.counts(node);
+    std::vector<float> probabilities(numClasses_, 0.0f);
+    float total = 0;
+    for (size_t k = 0; k < numClasses_; k++) {
+      probabilities[k] = counts[k];
+      total += counts[k];
+    }
+
+    //the majority class, ties go to the lowest class id
+    Category majority = 0;
+    for (size_t k = 0; k < numClasses_; k++) {
+      probabilities[k] /= total > 0 ? total : 1;
+      if (probabilities[k] > probabilities[majority])
+        majority = k;
+    }
+
+    nodes_[index].feature = -1;
+    nodes_[index].falseChild = classes_.size();
+    classes_.push_back(majority);
+    probabilities_.insert(probabilities_.end(), probabilities.begin(), probabilities.end());
+    return;
+  }
+
+  const Question& question = node.question;
+  nodes_[index].feature = question.column_;
+  nodes_[index].numeric = question.isNumeric();
+  if (question.isNumeric()) {
+    nodes_[index].threshold = question.threshold_;
+  } else {
+    nodes_[index].categories = categories_.size();
+    categories_.push_back(2 * question.categories_.size());
+    for (const uint64_t word: question.categories_) {
+      categories_.push_back(static_cast<uint32_t>(word));
+      categories_.push_back(static_cast<uint32_t>(word >> 32));
+    }
+  }
+
+  add(arena, node.trueChild);
+  nodes_[index].falseChild = nodes_.size();
+  add(arena, node.falseChild);
+}
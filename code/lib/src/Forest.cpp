@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include "Forest.hpp"
+
+Forest::Forest() :
+    conditions_({}), columnOffsets_({}), leafOffsets_({}), wordOffsets_({0}), leafClasses_({}), categories_({}), deep_({}),
+    numClasses_(0) {}
+
+Forest::Forest(const std::vector<const FlatTree*>& trees, size_t numClasses) :
+    conditions_({}),
+    columnOffsets_({}),
+    leafOffsets_({}),
+    wordOffsets_({0}),
+    leafClasses_({}),
+    categories_({}),
+    deep_({}),
+    numClasses_(numClasses) {
+  std::vector<std::vector<Condition>> columns;
+  for (const FlatTree* tree: trees) {
+    if (tree->leaves() > maxLeaves) {
+      deep_.push_back(*tree);
+      continue;
+    }
+
+    //the leaves of every tree start at a word boundary
+    uint32_t leaf = wordOffsets_.back() * 64;
+    collect(*tree, 0, leaf, columns);
+    wordOffsets_.push_back(wordOffsets_.back() + (tree->leaves() + 63) / 64);
+    leafOffsets_.push_back(leafClasses_.size());
+    for (size_t l = 0; l < tree->leaves(); l++)
+      leafClasses_.push_back(tree->leafClass(l));
+  }
+
+  //numeric conditions are visited from the highest threshold down until the example reaches it
+  columnOffsets_.push_back(0);
+  for (auto& column: columns) {
+    std::stable_sort(column.begin(), column.end(), [](const Condition& a, const Condition& b) {
+        return a.threshold > b.threshold;
+    });
+    conditions_.insert(conditions_.end(), column.begin(), column.end());
+    columnOffsets_.push_back(conditions_.size());
+  }
+}
+
+/**
+ * Method that turns the internal nodes of a flat tree into conditions.
+ *
+ * @param node - subtree to collect
+ * @param leaf - bit of the next leaf, in left to right order
+ * @param columns - receives the conditions per column
+ * @return - number of leaves in the subtree
+ */
+uint32_t Forest::collect(const FlatTree& tree, uint32_t node, uint32_t& leaf, std::vector<std::vector<Condition>>& columns) {
+  const FlatNode& flat = tree.nodes()[node];
+  if (flat.feature < 0) {
+    leaf++;
+    return 1;
+  }
+
+  const uint32_t begin = leaf;
+  const uint32_t true_leaves = collect(tree, node + 1, leaf, columns);
+  const uint32_t false_leaves = collect(tree, flat.falseChild, leaf, columns);
+
+  if (columns.size() <= static_cast<size_t>(flat.feature))
+    columns.resize(flat.feature + 1);
+
+  Condition condition;
+  condition.threshold = flat.numeric ? flat.threshold : 0.0f;
+  condition.categories = categories_.size();
+  if (!flat.numeric) {
+    const uint32_t* set = tree.categoryWords() + flat.categories;
+    categories_.insert(categories_.end(), set, set + 1 + set[0]);
+  }
+  condition.begin = begin;
+  condition.end = begin + true_leaves;
+  columns[flat.feature].push_back(condition);
+
+  return true_leaves + false_leaves;
+}
+
+/**
+ * Method that clears a range of bits, which mostly lies in one word.
+ *
+ * @param leaves - concatenated bitvectors
+ * @param begin, end - bits to clear
+ */
+void Forest::clear(uint64_t* leaves, uint32_t begin, uint32_t end) {
+  const uint32_t first = begin / 64, last = (end - 1) / 64;
+  const uint64_t low = ~uint64_t(0) << (begin % 64); //bits from begin on in the first word
+  const uint64_t high = ~uint64_t(0) >> (63 - (end - 1) % 64); //bits up to end - 1 in the last word
+  if (first == last) {
+    leaves[first] &= ~(low & high);
+    return;
+  }
+  leaves[first] &= ~low;
+  std::fill(leaves + first + 1, leaves + last, 0);
+  leaves[last] &= ~high;
+}
+
+/**
+ * Method that adds the votes of the bitvector trees for one row.
+ *
+ * @param leaves - scratch space, the words of all bitvector trees
+ * @param votes - numClasses_ counters
+ */
+void Forest::addVotes(const DataTable& data, size_t row, uint64_t* leaves, int* votes) const {
+  std::fill(leaves, leaves + wordOffsets_.back(), ~uint64_t(0));
+
+  for (size_t column = 0; column + 1 < columnOffsets_.size(); column++) {
+    const Condition* condition = conditions_.data() + columnOffsets_[column];
+    const Condition* last = conditions_.data() + columnOffsets_[column + 1];
+    if (condition == last)
+      continue;
+
+    if (data.isNumeric(column)) {
+      const float value = data.numeric(column)[row];
+      for (; condition != last && condition->threshold > value; condition++)
+        clear(leaves, condition->begin, condition->end);
+    } else {
+      const Category value = data.categories(column)[row];
+      for (; condition != last; condition++) {
+        const uint32_t* set = categories_.data() + condition->categories;
+        if (value / 32 >= set[0] || !((set[1 + value / 32] >> (value % 32)) & 1))
+          clear(leaves, condition->begin, condition->end);
+      }
+    }
+  }
+
+  //the exit leaf of a tree is its leftmost leaf that is still reachable, the last one is never cleared
+  for (size_t tree = 0; tree < leafOffsets_.size(); tree++) {
+    size_t word = wordOffsets_[tree];
+    while (leaves[word] == 0)
+      word++;
+    const size_t leaf = (word - wordOffsets_[tree]) * 64 + __builtin_ctzll(leaves[word]);
+    votes[leafClasses_[leafOffsets_[tree] + leaf]]++;
+  }
+}
+
+void Forest::votes(const DataTable& data, size_t row, int* votes) const {
+  std::fill(votes, votes + numClasses_, 0);
+  std::vector<uint64_t> leaves(wordOffsets_.back());
+  addVotes(data, row, leaves.data(), votes);
+  for (const FlatTree& tree: deep_)
+    votes[tree.predict(data, row)]++;
+}
+
+/**
+ * Method that predicts the majority vote of the trees for a range of rows,
+ * ties go to the lowest class id.
+ *
+ * @param begin, end - range of rows
+ * @param out - receives end - begin class ids
+ */
+void Forest::predict(const DataTable& data, size_t begin, size_t end, Category* out) const {
+  constexpr size_t block = 256;
+  std::vector<uint64_t> leaves(wordOffsets_.back());
+  std::vector<int> votes(block * numClasses_);
+  Category classes[block];
+
+  for (size_t first = begin; first < end; first += block) {
+    const size_t n = std::min(block, end - first);
+    std::fill(votes.begin(), votes.end(), 0);
+
+    for (size_t i = 0; i < n; i++)
+      addVotes(data, first + i, leaves.data(), votes.data() + i * numClasses_);
+    for (const FlatTree& tree: deep_) {
+      tree.predict(data, first, first + n, classes);
+      for (size_t i = 0; i < n; i++)
+        votes[i * numClasses_ + classes[i]]++;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      const int* counts = votes.data() + i * numClasses_;
+      out[first - begin + i] = std::max_element(counts, counts + numClasses_) - counts;
+    }
+  }
+}
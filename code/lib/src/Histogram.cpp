@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include "Histogram.hpp"
+
+using std::vector;
+
+Binning::Binning() : offsets_({0}), codes_({}), cuts_({}) {}
+
+Binning::Binning(const DataTable& data) : offsets_({0}), codes_(data.columns()), cuts_(data.columns()) {
+  for (size_t column = 0; column < data.columns(); column++) {
+    if (!data.isNumeric(column)) {
+      offsets_.push_back(offsets_.back() + data.dictionary(column).size());
+      continue;
+    }
+
+    const float* values = data.numeric(column);
+    vector<float> sorted(values, values + data.rows());
+    std::sort(sorted.begin(), sorted.end());
+
+    //the cuts are the lowest value of every bin: one bin per value when there are few distinct values,
+    //otherwise picked at equally spaced quantiles
+    vector<float>& cuts = cuts_[column];
+    for (size_t bin = 1; bin < maxBins && !sorted.empty(); bin++) {
+      const float cut = sorted[bin * sorted.size() / maxBins];
+      if (cut > sorted.front() && (cuts.empty() || cut > cuts.back()))
+        cuts.push_back(cut);
+    }
+
+    const auto distinct = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+    if (distinct <= static_cast<long>(maxBins))
+      cuts.assign(sorted.begin() + std::min<long>(1, distinct), sorted.begin() + distinct);
+
+    codes_[column].resize(data.rows());
+    for (size_t row = 0; row < data.rows(); row++)
+      codes_[column][row] = std::upper_bound(cuts.begin(), cuts.end(), values[row]) - cuts.begin();
+
+    offsets_.push_back(offsets_.back() + cuts.size() + 1);
+  }
+}
+
+/**
+ * Method that quantizes a table with the cuts of another binning, e.g. a block
+ * of rows with bins computed from a sample of the whole data set.
+ *
+ * @param cuts - binning whose bins are used
+ * @param data - rows to quantize, with the same columns and dictionaries
+ */
+Binning::Binning(const Binning& cuts, const DataTable& data) : offsets_(cuts.offsets_), codes_(data.columns()), cuts_(cuts.cuts_) {
+  for (size_t column = 0; column < data.columns(); column++) {
+    if (!data.isNumeric(column))
+      continue;
+    const float* values = data.numeric(column);
+    const vector<float>& columnCuts = cuts_[column];
+    codes_[column].resize(data.rows());
+    for (size_t row = 0; row < data.rows(); row++)
+      codes_[column][row] = std::upper_bound(columnCuts.begin(), columnCuts.end(), values[row]) - columnCuts.begin();
+  }
+}
+
+const Question Binning::question(size_t column, size_t bin) const {
+  return Question(column, cuts_[column][bin-1]);
+}
+
+size_t Binning::bin(size_t column, float value) const {
+  return std::upper_bound(cuts_[column].begin(), cuts_[column].end(), value) - cuts_[column].begin();
+}
+
+Histogram::Histogram() : numClasses_(0), counts_({}) {}
+
+Histogram::Histogram(const Binning& binning, size_t numClasses) :
+    numClasses_(numClasses),
+    counts_(binning.totalBins() * numClasses, 0) {}
+
+/**
+ * Method that adds the rows to the histogram, in one pass over the rows per column.
+ *
+ * For a sparse table, all rows are first counted in the bin of 0 of every
+ * numeric column, from the class counts of the rows, and every non-zero value
+ * then moves its row to its own bin. This costs O(rows + non-zero values)
+ * instead of O(rows * numeric columns).
+ *
+ * @param data - data set
+ * @param binning - quantization of the data set
+ * @param indexes - rows to add
+ */
+void Histogram::add(const DataTable& data, const Binning& binning, IndexRange indexes, const int* weights) {
+  const Category* classes = data.classes();
+  if (data.isSparse()) {
+    thread_local vector<int64_t> totals;
+    thread_local vector<size_t> zeros;
+    totals.assign(numClasses_, 0);
+    zeros.assign(binning.columns(), 0);
+    for (const auto& index: indexes)
+      totals[classes[index]] += weights ? weights[index] : 1;
+    for (size_t column = 0; column < binning.columns(); column++) {
+      if (!data.isNumeric(column))
+        continue;
+      zeros[column] = (binning.offset(column) + binning.bin(column, 0)) * numClasses_;
+      for (size_t k = 0; k < numClasses_; k++)
+        counts_[zeros[column] + k] += totals[k];
+    }
+
+    const uint32_t* entries = data.nonZeroColumns();
+    for (const auto& index: indexes) {
+      const int weight = weights ? weights[index] : 1;
+      const Category k = classes[index];
+      for (size_t entry = data.nonZeroStart(index); entry < data.nonZeroStart(index + 1); entry++) {
+        const uint32_t column = entries[entry];
+        counts_[(binning.offset(column) + binning.codes(column)[index]) * numClasses_ + k] += weight;
+        counts_[zeros[column] + k] -= weight;
+      }
+    }
+  }
+
+  for (size_t column = 0; column < binning.columns(); column++) {
+    int64_t* counts = counts_.data() + binning.offset(column) * numClasses_;
+    if (data.isNumeric(column)) {
+      if (data.isSparse())
+        continue;
+      const uint8_t* codes = binning.codes(column);
+      for (const auto& index: indexes)
+        counts[codes[index] * numClasses_ + classes[index]] += weights ? weights[index] : 1;
+    } else {
+      const Category* codes = data.categories(column);
+      for (const auto& index: indexes)
+        counts[codes[index] * numClasses_ + classes[index]] += weights ? weights[index] : 1;
+    }
+  }
+}
+
+void Histogram::subtract(const Histogram& other) {
+  for (size_t i = 0; i < counts_.size(); i++)
+    counts_[i] -= other.counts_[i];
+}
@@ -6,4 +6,4 @@
 
 #include "Leaf.hpp"
 
-Leaf::Leaf(const ClassCounter pred) : predictions_(std::move(pred)) {}
+Leaf::Leaf(ClassCounter pred) : predictions_(std::move(pred)) {}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile(const std::string& filename) : data_(nullptr), size_(0), open_(false) {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  if (::fstat(fd, &info) == 0) {
+    open_ = true;
+    if (info.st_size > 0) {
+      void* mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        ::madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapping);
+        size_ = info.st_size;
+      } else {
+        open_ = false;
+      }
+    }
+  }
+  ::close(fd); //the mapping stays valid after closing the descriptor
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr)
+    ::munmap(const_cast<char*>(data_), size_);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <limits>
+#include <stdexcept>
+#include "BinaryFile.hpp"
+#include "MappedFile.hpp"
+#include "ModelFile.hpp"
+
+using std::string;
+using BinaryFile::Reader;
+using BinaryFile::Writer;
+
+namespace {
+
+constexpr char magic[8] = {'C', 'A', 'R', 'T', 'T', 'R', 'E', 'E'};
+constexpr size_t tree_header = 3 * sizeof(uint64_t); // node, leaf and category-word counts
+
+static_assert(sizeof(FlatNode) == 16, "a flat node is stored as four 32-bit words");
+
+/**
+ * Method that returns an array of 32-bit words read from the file: the mapped
+ * words themselves on little-endian machines, a converted copy otherwise.
+ */
+template <typename T>
+const T* words(Reader& reader, size_t count, std::vector<T>& copy) {
+  static_assert(sizeof(T) % 4 == 0, "arrays are stored as 32-bit words");
+  if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+    throw std::runtime_error("Unexpected end of file");
+  const char* data = reader.bytes(count * sizeof(T));
+  reader.align();
+  if (BinaryFile::littleEndian())
+    return reinterpret_cast<const T*>(data);
+
+  Reader words(data, count * sizeof(T));
+  copy.resize(count);
+  for (auto& value: copy) {
+    uint32_t converted[sizeof(T) / 4];
+    for (auto& word: converted)
+      word = words.value<uint32_t>();
+    std::memcpy(&value, converted, sizeof(T));
+  }
+  return copy.data();
+}
+
+/**
+ * Method that checks that a loaded tree only refers to its own nodes, leaves
+ * and category words, to the columns of the schema and to known classes, so
+ * a corrupt file can't make a prediction read out of bounds.
+ */
+bool validTree(const FlatTree& tree, const MetaData& schema) {
+  const size_t columns = schema.labels.empty() ? 0 : schema.labels.size() - 1;
+  if (tree.size() == 0 || tree.leaves() == 0)
+    return false;
+
+  const FlatNode* nodes = tree.nodes();
+  for (size_t i = 0; i < tree.size(); i++) {
+    const FlatNode& node = nodes[i];
+    if (node.feature < 0) {
+      if (node.feature != -1 || node.falseChild >= tree.leaves())
+        return false;
+      continue;
+    }
+
+    //children follow their parent depth-first, so a walk always ends in a leaf
+    const size_t feature = node.feature;
+    if (feature >= columns || i + 1 >= tree.size() || node.falseChild <= i + 1 || node.falseChild >= tree.size())
+      return false;
+    const auto type = schema.labelMap.find(schema.labels[feature]);
+    if ((node.numeric != 0) != (type != std::end(schema.labelMap) && type->second == "NUMERIC"))
+      return false;
+    if (!node.numeric && (node.categories >= tree.categoryWordCount()
+        || tree.categoryWords()[node.categories] >= tree.categoryWordCount() - node.categories))
+      return false;
+  }
+
+  for (size_t leaf = 0; leaf < tree.leaves(); leaf++) {
+    if (tree.leafClass(leaf) >= tree.numClasses())
+      return false;
+  }
+  return true;
+}
+
+template <typename T>
+void writeWords(Writer& writer, const T* data, size_t count) {
+  if (BinaryFile::littleEndian()) {
+    writer.bytes(data, count * sizeof(T));
+  } else {
+    writer.values(reinterpret_cast<const uint32_t*>(data), count * sizeof(T) / 4);
+  }
+  writer.align();
+}
+
+} // namespace
+
+/**
+ * Method that writes trees to a model file.
+ *
+ * @param filename - path of the model file
+ * @param schema - schema of the training data, see DataTable::schema
+ * @param trees - trees of the model, all with the same number of classes
+ */
+void ModelFile::save(const string& filename, const MetaData& schema, const std::vector<const FlatTree*>& trees) {
+  Writer writer(filename);
+  writer.bytes(magic, sizeof(magic));
+  writer.value<uint32_t>(version);
+  writer.value<uint32_t>(0); // reserved
+  writer.meta(schema);
+  writer.value<uint64_t>(trees.empty() ? 0 : trees.front()->numClasses());
+  writer.value<uint64_t>(trees.size());
+  writer.align();
+
+  for (const FlatTree* tree: trees) {
+    writer.value<uint64_t>(tree->size());
+    writer.value<uint64_t>(tree->leaves());
+    writer.value<uint64_t>(tree->categoryWordCount());
+    writeWords(writer, tree->nodes(), tree->size());
+    writeWords(writer, tree->leafClasses(), tree->leaves());
+    writeWords(writer, tree->leafProbabilities(), tree->leaves() * tree->numClasses());
+    writeWords(writer, tree->categoryWords(), tree->categoryWordCount());
+  }
+
+  if (!writer.good())
+    throw std::runtime_error("Can't write model file: " + filename);
+}
+
+/**
+ * Method that maps a model file. The returned trees keep the mapping open.
+ *
+ * @param filename - path of the model file
+ * @param schema - receives the schema of the training data
+ * @return - trees of the model
+ */
+std::vector<FlatTree> ModelFile::load(const string& filename, MetaData& schema) {
+  auto file = std::make_shared<const MappedFile>(filename);
+  if (!file->isOpen())
+    throw std::runtime_error("Can't open file: " + filename);
+
+  Reader reader(file->data(), file->size());
+  if (string(reader.bytes(sizeof(magic)), sizeof(magic)) != string(magic, sizeof(magic)))
+    throw std::runtime_error("Not a model file: " + filename);
+  if (reader.value<uint32_t>() != version)
+    throw std::runtime_error("Unsupported model file version: " + filename);
+  reader.value<uint32_t>();
+  schema = reader.meta();
+  const auto numClasses = reader.value<uint64_t>();
+  const auto count = reader.value<uint64_t>();
+  reader.align();
+  if (count > reader.remaining() / tree_header)
+    throw std::runtime_error("Corrupt model file: " + filename);
+
+  std::vector<FlatTree> trees(count);
+  for (auto& tree: trees) {
+    tree.numClasses_ = numClasses;
+    tree.size_ = reader.value<uint64_t>();
+    tree.leaves_ = reader.value<uint64_t>();
+    tree.categoryWords_ = reader.value<uint64_t>();
+    tree.nodesView_ = words(reader, tree.size_, tree.nodes_);
+    tree.classesView_ = words(reader, tree.leaves_, tree.classes_);
+    if (numClasses != 0 && tree.leaves_ > std::numeric_limits<size_t>::max() / numClasses)
+      throw std::runtime_error("Corrupt model file: " + filename);
+    tree.probabilitiesView_ = words(reader, tree.leaves_ * numClasses, tree.probabilities_);
+    tree.categoriesView_ = words(reader, tree.categoryWords_, tree.categories_);
+    if (!validTree(tree, schema))
+      throw std::runtime_error("Corrupt model file: " + filename);
+    if (BinaryFile::littleEndian())
+      tree.mapping_ = file;
+  }
+  return trees;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "Calculations.hpp"
+#include "NodeArena.hpp"
+
+NodeArena::NodeArena() : nodes_({}), counts_({}), numClasses_(0), mutex_() {}
+
+NodeArena::NodeArena(size_t numClasses) : nodes_({}), counts_({}), numClasses_(numClasses), mutex_() {}
+
+NodeArena::NodeArena(const NodeArena& other) :
+    nodes_(other.nodes_), counts_(other.counts_), numClasses_(other.numClasses_), mutex_() {}
+
+NodeArena::NodeArena(NodeArena&& other) noexcept :
+    nodes_(std::move(other.nodes_)), counts_(std::move(other.counts_)), numClasses_(other.numClasses_), mutex_() {}
+
+NodeArena& NodeArena::operator=(const NodeArena& other) {
+  if (this != &other) {
+    nodes_ = other.nodes_;
+    counts_ = other.counts_;
+    numClasses_ = other.numClasses_;
+  }
+  return *this;
+}
+
+NodeArena& NodeArena::operator=(NodeArena&& other) noexcept {
+  nodes_ = std::move(other.nodes_);
+  counts_ = std::move(other.counts_);
+  numClasses_ = other.numClasses_;
+  return *this;
+}
+
+/**
+ * Method that adds a leaf.
+ *
+ * @param counts - number of training rows per class id, numClasses() values
+ * @return - index of the leaf
+ */
+uint32_t NodeArena::addLeaf(const std::vector<int>& counts) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const int32_t leaf = counts_.size() / numClasses_;
+  counts_.insert(counts_.end(), counts.begin(), counts.end());
+  nodes_.push_back(ArenaNode{Question(), 0, 0, leaf});
+  return nodes_.size() - 1;
+}
+
+/**
+ * Method that adds an internal node whose children are already in the arena.
+ *
+ * @return - index of the node
+ */
+uint32_t NodeArena::addSplit(const Question& question, uint32_t trueChild, uint32_t falseChild) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nodes_.push_back(ArenaNode{question, trueChild, falseChild, -1});
+  return nodes_.size() - 1;
+}
+
+std::shared_ptr<Node> NodeArena::toNode(uint32_t index) const {
+  const ArenaNode& node = nodes_[index];
+  if (node.leaf >= 0) {
+    const int* leaf = counts(node);
+    return std::make_shared<Node>(Leaf(Calculations::toClassCounter(std::vector<int>(leaf, leaf + numClasses_))));
+  }
+  return std::make_shared<Node>(*toNode(node.trueChild), *toNode(node.falseChild), node.question);
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include "ArffStream.hpp"
+#include "Calculations.hpp"
+#include "Histogram.hpp"
+#include "OutOfCore.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+constexpr uint32_t closed = std::numeric_limits<uint32_t>::max(); // the row is in a leaf
+
+/**
+ * Node id of every row, in memory or in a temporary file.
+ */
+class Assignments {
+  public:
+    Assignments(size_t rows, bool onDisk) : memory_({}), file_(nullptr) {
+      if (!onDisk) {
+        memory_.assign(rows, 0);
+        return;
+      }
+
+      file_ = std::tmpfile();
+      if (file_ == nullptr)
+        throw std::runtime_error("Can't create a temporary file for the row assignments");
+      const std::vector<uint32_t> zeros(1 << 16, 0);
+      for (size_t row = 0; row < rows; row += zeros.size())
+        std::fwrite(zeros.data(), sizeof(uint32_t), std::min(zeros.size(), rows - row), file_);
+    }
+    ~Assignments() {
+      if (file_ != nullptr)
+        std::fclose(file_);
+    }
+
+    Assignments(const Assignments&) = delete;
+    Assignments& operator=(const Assignments&) = delete;
+
+    void read(size_t begin, size_t count, uint32_t* out) {
+      if (file_ == nullptr) {
+        std::copy_n(memory_.begin() + begin, count, out);
+        return;
+      }
+      std::fseek(file_, begin * sizeof(uint32_t), SEEK_SET);
+      if (std::fread(out, sizeof(uint32_t), count, file_) != count)
+        throw std::runtime_error("Can't read the row assignments");
+    }
+
+    void write(size_t begin, size_t count, const uint32_t* in) {
+      if (file_ == nullptr) {
+        std::copy_n(in, count, memory_.begin() + begin);
+        return;
+      }
+      std::fseek(file_, begin * sizeof(uint32_t), SEEK_SET);
+      if (std::fwrite(in, sizeof(uint32_t), count, file_) != count)
+        throw std::runtime_error("Can't write the row assignments");
+    }
+
+  private:
+    std::vector<uint32_t> memory_;
+    std::FILE* file_;
+};
+
+/**
+ * Node of the tree under construction.
+ */
+struct Record {
+  Record() : question(), split(false), leaf(false), trueChild(0), falseChild(0), depth(0), counts({}) {}
+
+  Question question;
+  bool split;
+  bool leaf;
+  uint32_t trueChild;
+  uint32_t falseChild;
+  size_t depth;
+  std::vector<int64_t> counts; // class counts, for leaves
+};
+
+/**
+ * Method that converts the class counts of a leaf to the int counts of the
+ * arena. A file can hold more rows of a class than an int counts; then the
+ * counts are scaled down in proportion, which keeps the majority class and
+ * the probabilities of the leaf.
+ */
+std::vector<int> leafCounts(const std::vector<int64_t>& counts) {
+  const int64_t largest = counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+  const double scale = largest > std::numeric_limits<int>::max() ? double(std::numeric_limits<int>::max()) / largest : 1.0;
+  std::vector<int> result(counts.size());
+  for (size_t k = 0; k < counts.size(); k++)
+    result[k] = static_cast<int>(counts[k] * scale);
+  return result;
+}
+
+} // namespace
+
+namespace OutOfCore {
+
+/**
+ * Method that trains a tree by streaming an ARFF file, see OutOfCore.
+ *
+ * @param filename - path of the ARFF file
+ * @param classLabel - label of the class attribute
+ * @param options - threads, pool and memory budget
+ * @return - the tree, the schema of the data and the number of passes over the file
+ */
+Result train(const std::string& filename, const std::string& classLabel, const TreeOptions& options) {
+  const std::shared_ptr<ThreadPool> pool = options.pool ? options.pool : std::make_shared<ThreadPool>(options.threads);
+  const size_t budget = options.memoryBudget;
+  const size_t block_bytes = std::clamp<size_t>(budget / 8, 64 << 10, 256 << 20);
+  Profiler* profiler = options.profiler.get();
+  auto start = Profiler::Clock::now();
+
+  ArffStream stream(filename, classLabel, block_bytes);
+  const MetaData& meta = stream.metaData();
+
+  //scan: dictionaries, number of rows and a sample of every stride-th row, halved whenever it grows too large
+  DataTable dictionaries(meta);
+  DataTable sample(meta);
+  const size_t row_bytes = 4 * (meta.labels.size() + 1);
+  const size_t sample_rows = std::clamp<size_t>(budget / 8 / row_bytes, 1024, 1 << 20);
+  size_t rows = 0, stride = 1;
+
+  DataTable block;
+  while (stream.next(block, meta, *pool)) {
+    std::vector<size_t> picked;
+    for (size_t row = 0; row < block.rows(); row++)
+      if ((rows + row) % stride == 0)
+        picked.push_back(row);
+    dictionaries.append(block.select({}));
+    sample.append(block.select(picked));
+    rows += block.rows();
+
+    while (sample.rows() > 2 * sample_rows) {
+      std::vector<size_t> even;
+      for (size_t row = 0; row < sample.rows(); row += 2)
+        even.push_back(row);
+      sample = sample.select(even);
+      stride *= 2;
+    }
+  }
+  if (rows == 0)
+    throw std::runtime_error("No data in file: " + filename);
+  if (profiler)
+    profiler->record("pass", start, Profiler::Clock::now(), rows, true);
+
+  Result result{NodeArena(), 0, dictionaries.schema(meta), 0, 1};
+  const DataTable reference(result.schema); // no rows, fixes the columns and category ids of every block
+  sample.conform(reference);
+  const Binning binning(sample);
+  const size_t numClasses = reference.numClasses();
+  result.numClasses = numClasses;
+  result.tree = NodeArena(numClasses);
+  const std::vector<size_t> columns = Calculations::allColumns(reference); // options.maxFeatures and maxLeafNodes are not used out of core
+
+  //the budget left after the blocks and the assignments goes to the histograms of the open nodes
+  const bool on_disk = rows * sizeof(uint32_t) > budget / 4;
+  Assignments assignments(rows, on_disk);
+  const size_t histogram_bytes = std::max<size_t>(1, binning.totalBins() * numClasses * sizeof(int64_t));
+  const size_t reserved = 3 * block_bytes + (on_disk ? 0 : rows * sizeof(uint32_t));
+  const size_t max_open = std::max<size_t>(1, (budget > reserved ? budget - reserved : 0) / histogram_bytes);
+
+  std::vector<Record> records(1);
+  std::vector<uint32_t> open{0};
+  while (!open.empty()) {
+    const std::vector<uint32_t> batch(open.begin(), open.begin() + std::min(max_open, open.size()));
+    std::vector<uint32_t> waiting(open.begin() + batch.size(), open.end());
+
+    std::vector<int> slots(records.size(), -1);
+    for (size_t slot = 0; slot < batch.size(); slot++)
+      slots[batch[slot]] = slot;
+    std::vector<Histogram> histograms(batch.size(), Histogram(binning, numClasses));
+    std::vector<std::vector<int64_t>> counts(batch.size(), std::vector<int64_t>(numClasses, 0));
+
+    //one pass: move every row down the splits found so far and add it to the histogram of its node
+    start = Profiler::Clock::now();
+    stream.rewind();
+    std::vector<uint32_t> nodes;
+    for (size_t first = 0; stream.next(block, result.schema, *pool); first += block.rows()) {
+      nodes.resize(block.rows());
+      assignments.read(first, nodes.size(), nodes.data());
+
+      std::vector<std::vector<size_t>> members(batch.size());
+      const Category* classes = block.classes();
+      for (size_t row = 0; row < block.rows(); row++) {
+        uint32_t node = nodes[row];
+        if (node == closed)
+          continue;
+        while (records[node].split)
+          node = records[node].question.solve(block, row) ? records[node].trueChild : records[node].falseChild;
+        if (records[node].leaf)
+          node = closed;
+        nodes[row] = node;
+
+        if (node != closed && slots[node] >= 0) {
+          members[slots[node]].push_back(row);
+          counts[slots[node]][classes[row]]++;
+        }
+      }
+      assignments.write(first, nodes.size(), nodes.data());
+
+      const Binning codes(binning, block);
+      pool->parallelFor(0, batch.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t slot = begin; slot < end; slot++)
+          histograms[slot].add(block, codes, members[slot]);
+      });
+    }
+    result.passes++;
+    if (profiler)
+      profiler->record("pass", start, Profiler::Clock::now(), rows, true);
+
+    for (size_t slot = 0; slot < batch.size(); slot++) {
+      const uint32_t id = batch[slot];
+      const double size = std::accumulate(counts[slot].begin(), counts[slot].end(), 0.0);
+      if (profiler)
+        profiler->node(records[id].depth, size);
+
+      //the same pre-pruning limits as DecisionTree::findSplit
+      double gain = 0;
+      Question question;
+      const bool limited = (options.maxDepth > 0 && records[id].depth >= options.maxDepth) ||
+          size < options.minSamplesSplit || size < 2.0 * options.minSamplesLeaf;
+      if (!limited)
+        std::tie(gain, question) = Profiler::measure(profiler, "threshold scan", size, [&]() {
+          return Calculations::find_best_split(reference, binning, histograms[slot], columns, options.minSamplesLeaf);
+        });
+      if (gain * size / rows < options.minImpurityDecrease)
+        gain = 0;
+
+      if (gain == 0) {
+        records[id].leaf = true;
+        records[id].counts = std::move(counts[slot]);
+        continue;
+      }
+
+      const uint32_t child = records.size();
+      records.resize(child + 2);
+      records[id].split = true;
+      records[id].question = question;
+      records[id].trueChild = child;
+      records[id].falseChild = child + 1;
+      records[child].depth = records[child + 1].depth = records[id].depth + 1;
+      waiting.push_back(child);
+      waiting.push_back(child + 1);
+    }
+    open = std::move(waiting);
+  }
+
+  std::function<uint32_t(uint32_t)> build = [&](uint32_t id) -> uint32_t {
+    const Record& record = records[id];
+    if (!record.split)
+      return result.tree.addLeaf(leafCounts(record.counts));
+    const uint32_t trueChild = build(record.trueChild);
+    const uint32_t falseChild = build(record.falseChild);
+    return result.tree.addSplit(record.question, trueChild, falseChild);
+  };
+  result.root = build(0);
+  return result;
+}
+
+} // namespace OutOfCore
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Profiler.hpp"
+
+namespace {
+
+std::string quote(const std::string& text) {
+  std::string quoted = "\"";
+  for (const char c: text) {
+    if (c == '"' || c == '\\')
+      quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void write(const std::string& filename, const std::string& text) {
+  std::ofstream file(filename);
+  file << text;
+  if (!file)
+    throw std::runtime_error("Can't write file: " + filename);
+}
+
+} // namespace
+
+Profiler::Profiler() : mutex_(), origin_(Clock::now()), phases_({}), depths_({}), spans_({}), threads_({}) {}
+
+/**
+ * Method that adds a measurement to the total of its phase, see Scope.
+ *
+ * @param phase - name of the phase
+ * @param start - time the work started
+ * @param end - time the work ended
+ * @param items - amount of work, e.g. rows
+ * @param span - also keep it as a span of the trace
+ */
+void Profiler::record(const std::string& phase, Clock::time_point start, Clock::time_point end, size_t items, bool span) {
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = std::find_if(phases_.begin(), phases_.end(), [&phase](const Phase& p) { return p.name == phase; });
+  if (it == phases_.end())
+    it = phases_.insert(phases_.end(), Phase{phase, 0, 0, 0});
+  it->calls++;
+  it->seconds += seconds;
+  it->items += items;
+
+  if (span) {
+    const size_t thread = threads_.emplace(std::this_thread::get_id(), threads_.size()).first->second;
+    spans_.push_back(Span{phase, std::chrono::duration<double>(start - origin_).count(), seconds, thread});
+  }
+}
+
+/**
+ * Method that counts a node of a tree under construction.
+ *
+ * @param depth - depth of the node, 0 for the root
+ * @param rows - rows of the node, counted with their weights
+ */
+void Profiler::node(size_t depth, double rows) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (depths_.size() <= depth)
+    depths_.resize(depth + 1, Depth{0, 0});
+  depths_[depth].nodes++;
+  depths_[depth].rows += rows;
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  origin_ = Clock::now();
+  phases_.clear();
+  depths_.clear();
+  spans_.clear();
+  threads_.clear();
+}
+
+std::vector<Profiler::Phase> Profiler::phases() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return phases_;
+}
+
+Profiler::Phase Profiler::phase(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& phase: phases_)
+    if (phase.name == name)
+      return phase;
+  return Phase{name, 0, 0, 0};
+}
+
+std::vector<Profiler::Depth> Profiler::depths() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return depths_;
+}
+
+std::vector<Profiler::Span> Profiler::spans() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return spans_;
+}
+
+/**
+ * Method that exports the phases, depths and spans as a JSON object, times in
+ * seconds.
+ */
+std::string Profiler::json() const {
+  const auto phases = this->phases();
+  const auto depths = this->depths();
+  const auto spans = this->spans();
+
+  std::ostringstream out;
+  out.precision(9);
+  out << "{\n  \"phases\": [";
+  for (size_t i = 0; i < phases.size(); i++)
+    out << (i > 0 ? "," : "") << "\n    {\"name\": " << quote(phases[i].name) << ", \"calls\": " << phases[i].calls
+        << ", \"seconds\": " << phases[i].seconds << ", \"items\": " << phases[i].items << "}";
+  out << "\n  ],\n  \"depths\": [";
+  for (size_t i = 0; i < depths.size(); i++)
+    out << (i > 0 ? "," : "") << "\n    {\"depth\": " << i << ", \"nodes\": " << depths[i].nodes << ", \"rows\": " << depths[i].rows << "}";
+  out << "\n  ],\n  \"spans\": [";
+  for (size_t i = 0; i < spans.size(); i++)
+    out << (i > 0 ? "," : "") << "\n    {\"name\": " << quote(spans[i].name) << ", \"start\": " << spans[i].start
+        << ", \"seconds\": " << spans[i].duration << ", \"thread\": " << spans[i].thread << "}";
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+/**
+ * Method that exports the spans in the trace event format of chrome://tracing
+ * and Perfetto, one complete event per span with times in microseconds. The
+ * totals of the phases and the depths are added as extra keys, which the
+ * viewers ignore.
+ */
+std::string Profiler::chromeTrace() const {
+  const auto phases = this->phases();
+  const auto depths = this->depths();
+  const auto spans = this->spans();
+
+  std::ostringstream out;
+  out.precision(15);
+  out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+  for (size_t i = 0; i < spans.size(); i++)
+    out << (i > 0 ? "," : "") << "\n    {\"name\": " << quote(spans[i].name) << ", \"cat\": \"DecisionTree\", \"ph\": \"X\", \"ts\": "
+        << spans[i].start * 1e6 << ", \"dur\": " << spans[i].duration * 1e6 << ", \"pid\": 0, \"tid\": " << spans[i].thread << "}";
+  out << "\n  ],\n  \"phases\": {";
+  for (size_t i = 0; i < phases.size(); i++)
+    out << (i > 0 ? ", " : "") << quote(phases[i].name) << ": {\"calls\": " << phases[i].calls << ", \"seconds\": " << phases[i].seconds
+        << ", \"items\": " << phases[i].items << "}";
+  out << "},\n  \"depths\": [";
+  for (size_t i = 0; i < depths.size(); i++)
+    out << (i > 0 ? ", " : "") << "{\"nodes\": " << depths[i].nodes << ", \"rows\": " << depths[i].rows << "}";
+  out << "]\n}\n";
+  return out.str();
+}
+
+void Profiler::writeJson(const std::string& filename) const {
+  write(filename, json());
+}
+
+void Profiler::writeChromeTrace(const std::string& filename) const {
+  write(filename, chromeTrace());
+}
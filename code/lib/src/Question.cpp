@@ -4,42 +4,48 @@
  * Written by Pieter Robberechts, 2019
  */
 
+#include <sstream>
 #include "Question.hpp"
 #include "Utils.hpp"
 
 using std::string;
 using std::vector;
 
-Question::Question() : column_(0), value_("") {}
+Question::Question() : column_(0), numeric_(true), threshold_(0), categories_({}) {}
 
-Question::Question(const int column, const string value) : column_(column), value_(value) {}
+Question::Question(const int column, const float threshold) :
+    column_(column), numeric_(true), threshold_(threshold), categories_({}) {}
 
-const bool Question::solve(VecS example) const {
-  const string& val = example[column_];
-  if (isNumeric(val)) {
-    return std::stod(val) >= std::stod(value_);
-  } else {
-    return val == value_;
-  }
-}
-const string Question::toString(const VecS& labels) const {
-  string condition = "==";
-  if (isNumeric(value_))
-    condition = ">=";
-  return "Is " + labels[column_] + " " + condition + " " + value_ + "?";
+Question::Question(const int column, const Category category) :
+    column_(column), numeric_(false), threshold_(0), categories_(category / 64 + 1, 0) {
+  categories_[category / 64] |= uint64_t(1) << (category % 64);
 }
 
-const bool Question::isNumeric(std::string value) const {
-  if (bool empty = value.empty(); !empty) {
-    try {
-      std::stod(value);
-    } catch (const std::exception &e) {
-      return false;
-    }
+Question::Question(const int column, std::vector<uint64_t> categories) :
+    column_(column), numeric_(false), threshold_(0), categories_(std::move(categories)) {}
+
+const string Question::toString(const VecS& labels, const DataTable& data) const {
+  if (numeric_) {
+    std::ostringstream value;
+    value << threshold_;
+    return "Is " + labels[column_] + " >= " + value.str() + "?";
+  }
+
+  //a set of one category reads as an equality
+  std::vector<string> values;
+  for (Category category = 0; category < 64 * categories_.size(); category++) {
+    if (!contains(category))
+      continue;
+    values.push_back(category < data.dictionary(column_).size() ? data.dictionary(column_)[category] : std::to_string(category));
   }
-  return true;
+  if (values.size() == 1)
+    return "Is " + labels[column_] + " == " + values.front() + "?";
+  string set;
+  for (const auto& value: values)
+    set += (set.empty() ? "" : ", ") + value;
+  return "Is " + labels[column_] + " in {" + set + "}?";
 }
 
 const bool Question::isNumeric(void) const {
-  return Question::isNumeric(value_); 
+  return numeric_;
 }
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+namespace {
+
+// pool and queue of the worker running on this thread, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+// pool, group and depth of the task running on this thread, if any
+thread_local const ThreadPool* task_pool = nullptr;
+thread_local size_t task_group = 0;
+thread_local size_t task_depth = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) :
+    queues_(),
+    workers_(),
+    sleepMutex_(),
+    wakeUp_(),
+    waiters_(),
+    pending_(0),
+    groups_(0),
+    events_(0),
+    stop_(false) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  //the thread that waits on the pool also runs tasks, so it counts as one of the threads
+  const size_t workers = threads - 1;
+  for (size_t i = 0; i <= workers; i++)
+    queues_.push_back(std::make_unique<Queue>());
+
+  for (size_t i = 0; i < workers; i++)
+    workers_.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  wakeUp_.notify_all();
+  for (auto& worker: workers_)
+    worker.join();
+}
+
+void ThreadPool::push(std::function<void()> task) {
+  const bool nested = task_pool == this;
+  Task queued{std::move(task), nested ? task_group : groups_++, nested ? task_depth + 1 : 1};
+  Queue& queue = *queues_[queueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(queued));
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    pending_++;
+    events_++;
+  }
+  wakeUp_.notify_one();
+  waiters_.notify_all();
+}
+
+/**
+ * Method that tells whether the calling thread, which waits for a task, may
+ * run a pending task: any task when it waits outside a task of this pool,
+ * otherwise only a deeper task of the same group.
+ */
+bool ThreadPool::canHelp(const Task& task) const {
+  return task_pool != this || (task.group == task_group && task.depth > task_depth);
+}
+
+size_t ThreadPool::events() {
+  std::lock_guard<std::mutex> lock(sleepMutex_);
+  return events_;
+}
+
+/**
+ * Method that blocks until a task was pushed or finished after the calling
+ * thread read seen from events().
+ */
+void ThreadPool::sleepUntilEvent(size_t seen) {
+  std::unique_lock<std::mutex> lock(sleepMutex_);
+  waiters_.wait(lock, [this, seen]() { return events_ != seen; });
+}
+
+/**
+ * Method that runs one pending task: the newest task of the own queue if there
+ * is one, otherwise the oldest task of another queue. A waiting thread skips
+ * the tasks it can't help with, see canHelp.
+ *
+ * @param waiting - whether the calling thread waits for a task
+ * @return - whether a task was run
+ */
+bool ThreadPool::runPendingTask(bool waiting) {
+  const size_t own = queueIndex();
+  Task task{nullptr, 0, 0};
+
+  for (size_t i = 0; i < queues_.size() && !task.run; i++) {
+    Queue& queue = *queues_[(own + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+
+    if (i == 0) {
+      const auto found = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), [&](const Task& t) { return !waiting || canHelp(t); });
+      if (found == queue.tasks.rend())
+        continue;
+      task = std::move(*found);
+      queue.tasks.erase(std::next(found).base());
+    } else {
+      const auto found = std::find_if(queue.tasks.begin(), queue.tasks.end(), [&](const Task& t) { return !waiting || canHelp(t); });
+      if (found == queue.tasks.end())
+        continue;
+      task = std::move(*found);
+      queue.tasks.erase(found);
+    }
+  }
+
+  if (!task.run)
+    return false;
+
+  pending_--;
+  const ThreadPool* pool = task_pool;
+  const size_t group = task_group, depth = task_depth;
+  task_pool = this;
+  task_group = task.group;
+  task_depth = task.depth;
+  task.run();
+  task_pool = pool;
+  task_group = group;
+  task_depth = depth;
+
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    events_++;
+  }
+  waiters_.notify_all();
+  return true;
+}
+
+void ThreadPool::work(size_t index) {
+  current_pool = this;
+  current_queue = index;
+
+  while (true) {
+    if (runPendingTask())
+      continue;
+
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    wakeUp_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+    if (stop_ && pending_ == 0)
+      return;
+  }
+}
+
+size_t ThreadPool::queueIndex() const {
+  return current_pool == this ? current_queue : queues_.size() - 1;
+}
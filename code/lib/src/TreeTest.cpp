@@ -9,41 +9,55 @@
 using std::make_shared;
 using std::shared_ptr;
 
-TreeTest::TreeTest(const Data& testData, const MetaData& meta, const Node &root) {
+TreeTest::TreeTest(const DataTable& testData, const MetaData& meta, const Node &root) {
   test(testData, meta.labels, make_shared<Node>(root));
 }
 
-const ClassCounter TreeTest::classify(const VecS& row, shared_ptr<Node> node) const {
+TreeTest::TreeTest(const DataTable& testData, const std::vector<Category>& predictions) {
+  test(testData, predictions);
+}
+
+const ClassCounter TreeTest::classify(const DataTable& data, size_t row, shared_ptr<Node> node) const {
   if (bool is_leaf = node->leaf() != nullptr; is_leaf) {
     const auto &leaf = node->leaf();
     return leaf->predictions();
   }
 
-  if (node->question().solve(row))
-    return classify(row, node->trueBranch());
+  if (node->question().solve(data, row))
+    return classify(data, row, node->trueBranch());
   else
-    return classify(row, node->falseBranch());
+    return classify(data, row, node->falseBranch());
 }
 
-void TreeTest::printLeaf(ClassCounter counts) const {
+void TreeTest::printLeaf(ClassCounter counts, const VecS& classNames) const {
   const float total = static_cast<float>(Utils::tree::mapValueSum(counts));
   ClassCounterScaled scale;
 
   for (const auto& [key, val]: counts)
-    scale[key] = std::to_string(val / total * 100) + "%";
+    scale[classNames[key]] = std::to_string(val / total * 100) + "%";
 
   Utils::print::print_map(scale);
 }
 
-void TreeTest::test(const Data& testData, const VecS& labels, shared_ptr<Node> tree) const {
+void TreeTest::test(const DataTable& testData, const VecS& labels, shared_ptr<Node> tree) const {
   float accuracy = 0;
-  for (const auto& row: testData) {
-    const auto& classification = classify(row, tree);
-    static size_t last = row.size() - 1;
+  const Category* classes = testData.classes();
+  for (size_t row = 0; row < testData.rows(); row++) {
+    const auto& classification = classify(testData, row, tree);
     // Comment out this line to print the predicion of each example
-    // std::cout << "Actual: " << row[last] << "\tPrediction: "; printLeaf(classification);
-    if (Utils::tree::getMax(classification) == row[last])
+    // std::cout << "Actual: " << testData.classNames()[classes[row]] << "\tPrediction: "; printLeaf(classification, testData.classNames());
+    if (Utils::tree::getMax(classification) == classes[row])
+      accuracy += 1;
+  }
+  std::cout << "Total accuracy: " << (accuracy / testData.rows()) << std::endl;
+}
+
+void TreeTest::test(const DataTable& testData, const std::vector<Category>& predictions) const {
+  float accuracy = 0;
+  const Category* classes = testData.classes();
+  for (size_t row = 0; row < testData.rows(); row++) {
+    if (predictions[row] == classes[row])
       accuracy += 1;
   }
-  std::cout << "Total accuracy: " << (accuracy / testData.size()) << std::endl;
+  std::cout << "Total accuracy: " << (accuracy / testData.rows()) << std::endl;
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <numeric>
+#include "Bagging.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * A bag depends on its seed only: the trees, their out-of-bag votes and the
+ * out-of-bag accuracy are the same whatever the number of threads. A tree of
+ * a bag, trained on the distinct rows of its bootstrap weighted by their
+ * draws, is the tree trained on every draw.
+ */
+
+namespace {
+
+void sameBag(const Bagging& a, const Bagging& b, const DataTable& test, const std::string& name) {
+  check(!a.oobVotes().empty(), name + ": out-of-bag votes");
+  check(a.oobVotes() == b.oobVotes(), name + ": same out-of-bag votes");
+  check(a.oobAccuracy() == b.oobAccuracy(), name + ": same out-of-bag accuracy");
+
+  std::vector<Category> expected(test.rows()), predicted(test.rows());
+  a.predict(test, expected.data());
+  b.predict(test, predicted.data());
+  check(expected == predicted, name + ": same predictions");
+}
+
+void oobIndependentOfThreads(Splitter splitter, const std::string& name) {
+  TestData::Shape shape;
+  shape.rows = 3000;
+  const auto dr = TestData::reader(shape, 1);
+
+  TreeOptions sequential;
+  sequential.threads = 1;
+  sequential.splitter = splitter;
+  sequential.parallelCutoff = 64;
+  TreeOptions parallel = sequential;
+  parallel.threads = 4;
+  parallel.parallelFeatures = true;
+
+  Bagging a(dr.get(), 12, 1234, sequential);
+  Bagging b(dr.get(), 12, 1234, parallel);
+  sameBag(a, b, dr->testData(), name);
+
+  //pruning chooses alpha on the out-of-bag rows and counts their votes again
+  a.prune();
+  b.prune();
+  sameBag(a, b, dr->testData(), name + " pruned");
+}
+
+/**
+ * Method that compares a tree trained on a weighted bootstrap, the way the bag
+ * trains it, with a tree trained on the rows of the bootstrap repeated.
+ */
+void weightsMatchRepeatedRows(Splitter splitter, const std::string& name) {
+  TestData::Shape shape;
+  shape.rows = 1000;
+  const auto dr = TestData::reader(shape, 2);
+  const DataTable& data = dr->trainData();
+  TreeOptions options;
+  options.threads = 1;
+  options.splitter = splitter;
+  options.minSamplesLeaf = 3; //counted in draws
+  const Bagging bag(dr.get(), 1, 1234, options);
+  const Weights weights = bag.sampleData(data.rows(), 0);
+
+  std::vector<size_t> samples, draws, all(data.rows());
+  std::iota(all.begin(), all.end(), 0);
+  for (size_t row = 0; row < data.rows(); row++) {
+    if (weights[row] > 0)
+      samples.push_back(row);
+    draws.insert(draws.end(), weights[row], row);
+  }
+  const DecisionTree weighted = splitter == Splitter::Presorted
+      ? DecisionTree(dr.get(), Calculations::sample(Calculations::presort(data, all), weights), weights, options)
+      : splitter == Splitter::Histogram
+          ? DecisionTree(dr.get(), samples, weights, Binning(data), options)
+          : DecisionTree(dr.get(), samples, weights, options);
+  const DecisionTree repeated(dr.get(), draws, options);
+
+  const DataTable& test = dr->testData();
+  std::vector<float> expected(test.rows() * repeated.numClasses()), predicted(expected.size());
+  repeated.predictProba(test, expected.data());
+  weighted.predictProba(test, predicted.data());
+  check(draws.size() == data.rows() && samples.size() < data.rows(), name + ": bootstrap");
+  check(weighted.flat().size() == repeated.flat().size(), name + ": tree size");
+  check(expected == predicted, name + ": probabilities");
+}
+
+} // namespace
+
+int main() {
+  oobIndependentOfThreads(Splitter::Exact, "exact bag");
+  oobIndependentOfThreads(Splitter::Presorted, "presorted bag");
+  oobIndependentOfThreads(Splitter::Histogram, "histogram bag");
+  weightsMatchRepeatedRows(Splitter::Exact, "exact bootstrap");
+  weightsMatchRepeatedRows(Splitter::Presorted, "presorted bootstrap");
+  weightsMatchRepeatedRows(Splitter::Histogram, "histogram bootstrap");
+  return TestData::failures;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <numeric>
+#include "Calculations.hpp"
+#include "DecisionTree.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+using TestData::answers;
+
+/*
+ * The best subset of categories found by sorting them on their class
+ * proportions agrees with an exhaustive search over all subsets.
+ */
+
+namespace {
+
+/**
+ * Method that computes the weighted gini index of a partition of the rows,
+ * in the units of find_best_split.
+ */
+double loss(const DataTable& data, IndexRange rows, const int* weights, const std::vector<bool>& answers) {
+  const size_t K = data.numClasses();
+  std::vector<double> counts(2 * K, 0);
+  for (size_t i = 0; i < rows.size(); i++)
+    counts[(answers[i] ? 0 : K) + data.classes()[rows[i]]] += weights ? weights[rows[i]] : 1;
+
+  double N = 0, score = 0;
+  for (size_t branch = 0; branch < 2; branch++) {
+    const double size = std::accumulate(counts.begin() + branch * K, counts.begin() + (branch + 1) * K, 0.0);
+    double squares = 0;
+    for (size_t k = 0; k < K; k++)
+      squares += counts[branch * K + k] * counts[branch * K + k];
+    N += size;
+    score += size > 0 ? squares / size : 0;
+  }
+  return (N - score) / N;
+}
+
+/**
+ * Method that compares the best set of categories with all subsets of the
+ * categories of the node. For two classes the ordered search is exact, with
+ * more it is a heuristic that can't beat the exhaustive search.
+ */
+void bestSubsetMatchesExhaustiveSearch() {
+  for (size_t trial = 0; trial < 200; trial++) {
+    TestData::Shape shape;
+    shape.rows = 20 + trial % 7 * 15;
+    shape.numeric = 0;
+    shape.categorical = 1;
+    shape.cardinality = 2 + trial % 7;
+    shape.classes = 2 + trial % 3;
+    shape.noise = 0.5;
+    const DataTable data = TestData::table(shape, trial);
+    std::vector<size_t> rows(data.rows());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    const auto counts = Calculations::classCounts(data, rows);
+    const auto [question, found] = Calculations::determine_best_threshold(data, 0, rows, nullptr, counts, 1);
+
+    double best = std::numeric_limits<double>::infinity();
+    for (uint64_t set = 1; set + 1 < (uint64_t(1) << shape.cardinality); set++) {
+      const Question subset(0, std::vector<uint64_t>{set});
+      const auto split = answers(data, rows, subset);
+      if (std::count(split.begin(), split.end(), true) % static_cast<long>(rows.size()) != 0)
+        best = std::min(best, loss(data, rows, nullptr, split));
+    }
+
+    const std::string name = "best subset, trial " + std::to_string(trial);
+    if (std::isinf(best)) {
+      check(std::isinf(found), name + ": no split expected");
+      continue;
+    }
+    check(std::abs(found - loss(data, rows, nullptr, answers(data, rows, question))) < 1e-9, name + ": reported gini");
+    if (shape.classes == 2)
+      check(std::abs(found - best) < 1e-9, name + ": optimal for two classes");
+    else
+      check(found >= best - 1e-9, name + ": not better than exhaustive");
+  }
+}
+
+} // namespace
+
+int main() {
+  bestSubsetMatchesExhaustiveSearch();
+  return TestData::failures;
+}
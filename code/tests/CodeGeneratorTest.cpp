@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstdlib>
+#include <dlfcn.h>
+#include "Bagging.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * A generated source, compiled with the compiler of the build into a shared
+ * library, predicts what the tree or bag it was generated from predicts.
+ * Categorical inputs that are not category ids (negative, -infinity, NaN)
+ * are in no category set; the library is compiled with a check of float to
+ * integer conversions, so such an input must not reach the cast.
+ */
+
+namespace {
+
+using Predict = int (*)(const float*);
+using PredictProba = void (*)(const float*, float*);
+
+/**
+ * Compiled model, unloaded and removed at the end of its scope.
+ */
+class Library {
+  public:
+    explicit Library(const std::string& source) : path_(source + ".so"), handle_(nullptr) {
+      const std::string compile = std::string(CXX_COMPILER) + " -std=c++17 -O1 -shared -fPIC -fvisibility=hidden ";
+      const std::string files = source + " -o " + path_;
+      if (std::system((compile + "-fsanitize=float-cast-overflow -fno-sanitize-recover=all " + files).c_str()) != 0
+          && std::system((compile + files).c_str()) != 0) //without the sanitizer when the compiler has none
+        return;
+      handle_ = dlopen(path_.c_str(), RTLD_NOW | RTLD_LOCAL);
+    }
+    ~Library() {
+      if (handle_)
+        dlclose(handle_);
+      std::filesystem::remove(path_);
+    }
+
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+
+    template <typename F>
+    F function(const char* name) const { return handle_ ? reinterpret_cast<F>(dlsym(handle_, name)) : nullptr; }
+
+  private:
+    std::string path_;
+    void* handle_;
+};
+
+/**
+ * Method that returns the features of a row as the generated code takes them.
+ */
+std::vector<float> features(const DataTable& data, size_t row) {
+  std::vector<float> x(data.columns());
+  for (size_t column = 0; column < data.columns(); column++)
+    x[column] = data.isNumeric(column) ? data.numeric(column)[row] : data.categories(column)[row];
+  return x;
+}
+
+/**
+ * Method that compares a compiled model with the predictions of the library.
+ *
+ * @param expected - class ids predicted by the library for the rows of data
+ * @param probabilities - probabilities predicted by the library, empty to skip them
+ */
+void sameModel(const std::string& source, const DataTable& data, const std::vector<Category>& expected,
+               const std::vector<float>& probabilities, const std::string& name) {
+  const Library library(source);
+  const auto predict = library.function<Predict>("predict");
+  const auto predictProba = library.function<PredictProba>("predict_proba");
+  const auto numClasses = library.function<int (*)()>("num_classes");
+  check(predict && predictProba && numClasses, name + ": compiled and loaded");
+  if (!predict || !predictProba || !numClasses)
+    return;
+
+  const size_t classes = numClasses();
+  size_t wrong = 0, wrongProbabilities = 0, wrongInvalid = 0;
+  std::vector<float> out(classes);
+  for (size_t row = 0; row < data.rows(); row++) {
+    std::vector<float> x = features(data, row);
+    wrong += predict(x.data()) != static_cast<int>(expected[row]);
+    predictProba(x.data(), out.data());
+    if (!probabilities.empty())
+      wrongProbabilities += !std::equal(out.begin(), out.end(), probabilities.begin() + row * classes);
+
+    //values that are not category ids go where an id beyond every set goes
+    for (size_t column = 0; column < data.columns(); column++) {
+      if (data.isNumeric(column))
+        continue;
+      x[column] = 1e9f;
+      const int outside = predict(x.data());
+      for (const float invalid: {-1.0f, -0.5f, -std::numeric_limits<float>::infinity(),
+                                 std::numeric_limits<float>::quiet_NaN(), 1e30f}) {
+        x[column] = invalid;
+        wrongInvalid += predict(x.data()) != outside;
+      }
+      x[column] = data.categories(column)[row];
+    }
+  }
+  check(wrong == 0, name + ": " + std::to_string(wrong) + " predictions differ");
+  check(wrongProbabilities == 0, name + ": " + std::to_string(wrongProbabilities) + " probabilities differ");
+  check(wrongInvalid == 0, name + ": " + std::to_string(wrongInvalid) + " invalid categories in a set");
+}
+
+} // namespace
+
+int main() {
+  TestData::Shape shape;
+  shape.rows = 1000;
+  shape.cardinality = 40; //sets of more than one word
+  const auto dr = TestData::reader(shape, 1);
+  const DataTable& test = dr->testData();
+  TreeOptions options;
+  options.threads = 1;
+  const std::string prefix = (std::filesystem::temp_directory_path() / ("decisiontree-code-test-" + std::to_string(getpid()))).string();
+
+  const DecisionTree tree(dr.get(), options);
+  std::vector<Category> expected(test.rows());
+  std::vector<float> probabilities(test.rows() * tree.numClasses());
+  tree.predict(test, expected.data());
+  tree.predictProba(test, probabilities.data());
+  tree.generateCode(prefix + "-tree.cpp");
+  sameModel(prefix + "-tree.cpp", test, expected, probabilities, "tree");
+
+  const Bagging bag(dr.get(), 5, 1234, options);
+  bag.predict(test, expected.data());
+  bag.generateCode(prefix + "-bag.cpp");
+  sameModel(prefix + "-bag.cpp", test, expected, {}, "bag");
+
+  std::filesystem::remove(prefix + "-tree.cpp");
+  std::filesystem::remove(prefix + "-bag.cpp");
+  return TestData::failures;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <numeric>
+#include "DecisionTree.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * The pruning path computed in one pass by CostComplexity agrees with the
+ * weakest link pruning of Breiman et al.: collapse the nodes with the
+ * smallest increase of the error per removed leaf, over and over. The alpha
+ * chosen on held-out rows is the one of the path whose pruned tree classifies
+ * them best.
+ */
+
+namespace {
+
+/**
+ * Copy of a tree with the class counts of every node, pruned in place.
+ */
+struct Subtree {
+  std::vector<int> counts;
+  std::unique_ptr<Subtree> trueBranch;
+  std::unique_ptr<Subtree> falseBranch;
+
+  inline bool isLeaf() const { return !trueBranch; }
+  inline int errors() const { return std::accumulate(counts.begin(), counts.end(), 0) - *std::max_element(counts.begin(), counts.end()); }
+};
+
+std::unique_ptr<Subtree> copy(const Node& node, size_t numClasses) {
+  auto tree = std::make_unique<Subtree>();
+  tree->counts.assign(numClasses, 0);
+  if (node.leaf()) {
+    for (const auto& [category, count]: node.leaf()->predictions())
+      tree->counts[category] = count;
+    return tree;
+  }
+  tree->trueBranch = copy(*node.trueBranch(), numClasses);
+  tree->falseBranch = copy(*node.falseBranch(), numClasses);
+  for (size_t k = 0; k < numClasses; k++)
+    tree->counts[k] = tree->trueBranch->counts[k] + tree->falseBranch->counts[k];
+  return tree;
+}
+
+/**
+ * Method that returns the errors and the leaves of a subtree.
+ */
+std::pair<int, size_t> size(const Subtree& tree) {
+  if (tree.isLeaf())
+    return {tree.errors(), 1};
+  const auto [trueErrors, trueLeaves] = size(*tree.trueBranch);
+  const auto [falseErrors, falseLeaves] = size(*tree.falseBranch);
+  return {trueErrors + falseErrors, trueLeaves + falseLeaves};
+}
+
+/**
+ * Method that returns the increase of the errors per removed leaf when a
+ * node is collapsed, the lowest one of the nodes of the subtree.
+ */
+double weakestLink(const Subtree& tree) {
+  if (tree.isLeaf())
+    return std::numeric_limits<double>::infinity();
+  const auto [errors, leaves] = size(tree);
+  const double link = static_cast<double>(tree.errors() - errors) / (leaves - 1);
+  return std::min({link, weakestLink(*tree.trueBranch), weakestLink(*tree.falseBranch)});
+}
+
+void collapse(Subtree& tree, double link) {
+  if (tree.isLeaf())
+    return;
+  const auto [errors, leaves] = size(tree);
+  if (static_cast<double>(tree.errors() - errors) / (leaves - 1) <= link + 1e-9) {
+    tree.trueBranch.reset();
+    tree.falseBranch.reset();
+    return;
+  }
+  collapse(*tree.trueBranch, link);
+  collapse(*tree.falseBranch, link);
+}
+
+/**
+ * Method that compares the pruning path of a tree, and the number of leaves
+ * left at each of its alphas, with weakest link pruning.
+ */
+void pathMatchesWeakestLink(const TestData::Shape& shape, uint64_t seed, const TreeOptions& options) {
+  const auto dr = TestData::reader(shape, seed);
+  const DecisionTree tree(dr.get(), options);
+  auto subtree = copy(*tree.root(), tree.numClasses());
+  const double rows = std::accumulate(subtree->counts.begin(), subtree->counts.end(), 0.0);
+
+  //alphas at which the tree changes, with the leaves left from each of them on
+  std::vector<std::pair<double, size_t>> expected{{0, size(*subtree).second}};
+  while (!subtree->isLeaf()) {
+    const double link = weakestLink(*subtree);
+    collapse(*subtree, link);
+    if (link / rows <= expected.back().first + 1e-12)
+      expected.back().second = size(*subtree).second;
+    else
+      expected.emplace_back(link / rows, size(*subtree).second);
+  }
+
+  const std::string name = "pruning path, seed " + std::to_string(seed);
+  const std::vector<double> path = tree.pruningPath();
+  check(path.size() == expected.size(), name + ": length " + std::to_string(path.size()) + " instead of " + std::to_string(expected.size()));
+  for (size_t i = 0; i < std::min(path.size(), expected.size()); i++) {
+    check(std::abs(path[i] - expected[i].first) < 1e-12, name + ": alpha " + std::to_string(i));
+    DecisionTree pruned = tree;
+    pruned.prune(path[i]);
+    check(pruned.flat().leaves() == expected[i].second, name + ": leaves at alpha " + std::to_string(i));
+  }
+}
+
+/**
+ * Method that prunes a tree at every alpha of its path, counts the correct
+ * held-out rows of each pruned tree and compares the best alpha, the largest
+ * one among equals, with the alpha chosen in one pass.
+ */
+void selectMatchesEveryAlpha(const TestData::Shape& shape, uint64_t seed, const TreeOptions& options) {
+  const auto dr = TestData::reader(shape, seed);
+  const DataTable& heldOut = dr->testData();
+  std::vector<size_t> rows; //every other row, to select on a part of the data
+  for (size_t row = seed % 2; row < heldOut.rows(); row += 2)
+    rows.push_back(row);
+  const DecisionTree tree(dr.get(), options);
+
+  double expected = 0;
+  size_t best = 0;
+  std::vector<Category> predicted(heldOut.rows());
+  for (const double alpha: tree.pruningPath()) {
+    DecisionTree pruned = tree;
+    pruned.prune(alpha);
+    pruned.predict(heldOut, predicted.data());
+    const size_t correct = std::count_if(rows.begin(), rows.end(), [&](size_t row) { return predicted[row] == heldOut.classes()[row]; });
+    if (correct >= best) {
+      best = correct;
+      expected = alpha;
+    }
+  }
+
+  DecisionTree selected = tree;
+  const std::string name = "selected alpha, seed " + std::to_string(seed);
+  check(selected.prune(heldOut, IndexRange(rows.data(), rows.data() + rows.size())) == expected, name);
+}
+
+} // namespace
+
+int main() {
+  TreeOptions options;
+  options.threads = 1;
+  for (uint64_t seed = 1; seed <= 10; seed++) {
+    TestData::Shape shape;
+    shape.rows = 200 + seed * 100;
+    shape.classes = 2 + seed % 3;
+    pathMatchesWeakestLink(shape, seed, options);
+  }
+
+  //a tree grown with pre-pruning has fewer, larger leaves
+  options.minSamplesLeaf = 5;
+  options.maxDepth = 6;
+  TestData::Shape shape;
+  shape.rows = 1000;
+  pathMatchesWeakestLink(shape, 11, options);
+
+  options = TreeOptions();
+  options.threads = 1;
+  for (uint64_t seed = 1; seed <= 10; seed++) {
+    TestData::Shape noisy;
+    noisy.rows = 300 + seed * 100;
+    noisy.noise = 0.3 + 0.05 * seed;
+    selectMatchesEveryAlpha(noisy, seed, options);
+  }
+
+  return TestData::failures;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstring>
+#include "DataCache.hpp"
+#include "Profiler.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * A data cache gives back the table it was written from. A cache that is
+ * stale, truncated or has damaged sizes is not used: the reader parses the
+ * ARFF file again, without throwing or printing, and a cache that can't be
+ * written is only recorded in the profiler.
+ */
+
+namespace {
+
+bool sameTable(const DataTable& a, const DataTable& b) {
+  if (a.rows() != b.rows() || a.columns() != b.columns() || a.classNames() != b.classNames())
+    return false;
+  for (size_t column = 0; column < a.columns(); column++) {
+    if (a.isNumeric(column) != b.isNumeric(column))
+      return false;
+    if (a.isNumeric(column) && std::memcmp(a.numeric(column), b.numeric(column), a.rows() * sizeof(float)) != 0)
+      return false;
+    if (!a.isNumeric(column) && (a.dictionary(column) != b.dictionary(column) ||
+        std::memcmp(a.categories(column), b.categories(column), a.rows() * sizeof(Category)) != 0))
+      return false;
+  }
+  return std::memcmp(a.classes(), b.classes(), a.rows() * sizeof(Category)) == 0;
+}
+
+/**
+ * Method that overwrites bytes of a file in place.
+ */
+void patch(const std::string& filename, size_t offset, uint64_t value) {
+  std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(offset);
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void truncate(const std::string& filename) {
+  std::filesystem::resize_file(filename, std::filesystem::file_size(filename) / 2);
+}
+
+} // namespace
+
+int main() {
+  const auto directory = std::filesystem::temp_directory_path();
+  const std::string prefix = "decisiontree-cache-test-" + std::to_string(getpid());
+  Dataset dataset;
+  dataset.train.filename = (directory / (prefix + "-train.arff")).string();
+  dataset.test.filename = (directory / (prefix + "-test.arff")).string();
+  dataset.classLabel = "class";
+  const std::string cache = DataCache::path(dataset.train.filename);
+
+  TestData::Shape shape;
+  TestData::writeArff(dataset.train.filename, shape, TestData::table(shape, 1));
+  TestData::writeArff(dataset.test.filename, shape, TestData::table(shape, 2));
+  const DataReader parsed(dataset);
+
+  dataset.useCache = true;
+  const DataReader written(dataset);
+  check(std::filesystem::exists(cache), "cache written");
+  const DataReader cached(dataset);
+  check(sameTable(parsed.trainData(), written.trainData()), "table of the run that wrote the cache");
+  check(sameTable(parsed.trainData(), cached.trainData()), "table read from the cache");
+  check(sameTable(parsed.testData(), cached.testData()), "test table read from the cache");
+
+  //damaged caches: rows of the header, the length of the class label, the number of labels, a truncated file
+  const size_t header = 48, labels = header + 8 + dataset.classLabel.size();
+  const std::vector<std::pair<size_t, uint64_t>> patches{{32, uint64_t(1) << 62}, {header, ~uint64_t(0)}, {labels, uint64_t(1) << 60}};
+  for (size_t i = 0; i <= patches.size(); i++) {
+    const std::string name = "damaged cache " + std::to_string(i);
+    const DataReader rewrite(dataset); //rewrites the cache
+    if (i < patches.size())
+      patch(cache, patches[i].first, patches[i].second);
+    else
+      truncate(cache);
+    DataTable data;
+    MetaData meta;
+    check(!DataCache::read(cache, dataset.train.filename, dataset.classLabel, data, meta), name + ": not used");
+    try {
+      const DataReader reread(dataset);
+      check(sameTable(parsed.trainData(), reread.trainData()), name + ": file parsed again");
+    } catch (const std::exception& error) {
+      check(false, name + ": " + error.what());
+    }
+  }
+
+  //a changed source makes the cache stale
+  TestData::Shape larger = shape;
+  larger.rows = 600;
+  TestData::writeArff(dataset.train.filename, larger, TestData::table(larger, 3));
+  dataset.useCache = false;
+  const DataReader changed(dataset);
+  dataset.useCache = true;
+  check(sameTable(changed.trainData(), DataReader(dataset).trainData()), "stale cache");
+
+  //a cache that can't be written
+  std::filesystem::remove(cache);
+  std::filesystem::create_directories(cache + "/blocked");
+  dataset.profiler = std::make_shared<Profiler>();
+  check(sameTable(changed.trainData(), DataReader(dataset).trainData()), "unwritable cache: file parsed");
+  check(dataset.profiler->phase("cache write failed").calls == 1, "unwritable cache: recorded");
+
+  std::filesystem::remove_all(cache);
+  std::filesystem::remove(DataCache::path(dataset.test.filename));
+  std::filesystem::remove(dataset.train.filename);
+  std::filesystem::remove(dataset.test.filename);
+  return TestData::failures;
+}
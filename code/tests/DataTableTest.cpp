@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "DataTable.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * Numeric cells are read like std::stod read them: signs, exponents and
+ * values beyond the range of a float are accepted, and missing values and
+ * NaN both become minus infinity.
+ */
+
+namespace {
+
+void parses(const std::string& cell, float expected) {
+  float value = 0;
+  check(DataTable::parseNumeric(cell, value) && value == expected, "parse " + cell);
+}
+
+void rejects(const std::string& cell) {
+  float value = 0;
+  check(!DataTable::parseNumeric(cell, value), "reject " + cell);
+}
+
+} // namespace
+
+int main() {
+  const float infinity = std::numeric_limits<float>::infinity();
+  parses("1.5", 1.5f);
+  parses("-3", -3);
+  parses("+2", 2);
+  parses("2.5e2", 250);
+  parses("1e-50", 0);
+  parses("1e39", infinity);
+  parses("-1e39", -infinity);
+  parses("1e400", infinity);
+  parses("?", -infinity);
+  parses("nan", -infinity);
+  parses("-nan", -infinity);
+
+  rejects("");
+  rejects("+");
+  rejects("+-1");
+  rejects("1.5x");
+  rejects("red");
+  return TestData::failures;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include "Forest.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * The forest engine gives every row the votes of its trees one by one: small
+ * trees in one word, deep trees whose bitvectors span several words, and
+ * trees beyond Forest::maxLeaves that are traversed.
+ */
+
+namespace {
+
+/**
+ * Method that compares the votes of a forest with the predictions of its trees.
+ *
+ * @param rows - training rows of every tree, more rows grow more leaves
+ * @return - leaves of the largest tree
+ */
+size_t votesMatchTrees(const std::vector<size_t>& rows, const std::string& name) {
+  std::vector<std::unique_ptr<DataReader>> readers;
+  std::vector<DecisionTree> trees;
+  TreeOptions options;
+  options.threads = 1;
+  for (size_t i = 0; i < rows.size(); i++) {
+    TestData::Shape shape;
+    shape.rows = rows[i];
+    shape.cardinality = 40; //sets of more than one word
+    shape.noise = 0.6;
+    readers.push_back(TestData::reader(shape, 100 + i));
+    trees.emplace_back(readers.back().get(), options);
+  }
+
+  std::vector<const FlatTree*> flat;
+  size_t most = 0;
+  for (const DecisionTree& tree: trees) {
+    flat.push_back(&tree.flat());
+    most = std::max(most, tree.flat().leaves());
+  }
+  const Forest forest(flat, trees.front().numClasses());
+  check(forest.trees() == trees.size(), name + ": trees");
+
+  const DataTable& test = readers.front()->testData();
+  std::vector<int> votes(forest.numClasses()), expected(forest.numClasses());
+  std::vector<Category> predicted(test.rows());
+  forest.predict(test, 0, test.rows(), predicted.data());
+  size_t wrongVotes = 0, wrongPredictions = 0;
+  for (size_t row = 0; row < test.rows(); row++) {
+    std::fill(expected.begin(), expected.end(), 0);
+    for (const DecisionTree& tree: trees)
+      expected[tree.flat().predict(test, row)]++;
+    forest.votes(test, row, votes.data());
+    wrongVotes += votes != expected;
+    wrongPredictions += predicted[row] != std::max_element(expected.begin(), expected.end()) - expected.begin();
+  }
+  check(wrongVotes == 0, name + ": votes of " + std::to_string(wrongVotes) + " rows differ");
+  check(wrongPredictions == 0, name + ": majority of " + std::to_string(wrongPredictions) + " rows differs");
+  return most;
+}
+
+} // namespace
+
+int main() {
+  check(votesMatchTrees({40, 100, 200}, "shallow") <= 64, "shallow: trees of one word");
+  check(votesMatchTrees({1000, 2000, 4000, 150}, "deep") > 64, "deep: trees of several words");
+  check(votesMatchTrees({30000, 2000}, "traversed") > Forest::maxLeaves, "traversed: trees beyond maxLeaves");
+  return TestData::failures;
+}
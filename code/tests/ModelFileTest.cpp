@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "Bagging.hpp"
+#include "ModelFile.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * A saved tree or bag predicts the same after loading. A truncated or damaged
+ * model file either loads trees that pass validation or throws
+ * std::runtime_error, never another exception from an allocation sized by
+ * the file.
+ */
+
+namespace {
+
+std::string modelPath(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / ("decisiontree-model-test-" + std::to_string(getpid()) + "-" + name)).string();
+}
+
+/**
+ * Method that loads a model file and reports anything but a clean load or a
+ * std::runtime_error.
+ */
+void loadsOrFails(const std::string& filename, const std::string& name) {
+  try {
+    MetaData schema;
+    ModelFile::load(filename, schema);
+  } catch (const std::runtime_error&) {
+  } catch (const std::exception& error) {
+    check(false, name + ": " + error.what());
+  }
+}
+
+void damagedFiles(const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  const std::string damaged = modelPath("damaged.model");
+
+  for (size_t size = 0; size < bytes.size(); size += 5) {
+    std::ofstream(damaged, std::ios::binary).write(bytes.data(), size);
+    loadsOrFails(damaged, "truncated to " + std::to_string(size) + " bytes");
+  }
+
+  //counts and lengths are 64-bit words at 8-byte offsets
+  for (size_t offset = 0; offset + 8 <= bytes.size(); offset += 8) {
+    for (const uint64_t value: {uint64_t(1) << 40, uint64_t(1) << 60, ~uint64_t(0)}) {
+      std::string patched = bytes;
+      std::memcpy(&patched[offset], &value, sizeof(value));
+      std::ofstream(damaged, std::ios::binary).write(patched.data(), patched.size());
+      loadsOrFails(damaged, "word at " + std::to_string(offset) + " set to " + std::to_string(value));
+    }
+  }
+  std::filesystem::remove(damaged);
+}
+
+} // namespace
+
+int main() {
+  TestData::Shape shape;
+  shape.rows = 1000;
+  const auto dr = TestData::reader(shape, 1);
+  const DataTable& test = dr->testData();
+  TreeOptions options;
+  options.threads = 1;
+
+  const std::string treeFile = modelPath("tree.model");
+  const DecisionTree tree(dr.get(), options);
+  tree.save(treeFile);
+  const DecisionTree loaded = DecisionTree::load(treeFile, options);
+  std::vector<Category> expected(test.rows()), predicted(test.rows());
+  tree.predict(test, expected.data());
+  loaded.predict(test, predicted.data());
+  check(expected == predicted, "tree: predictions");
+  std::vector<float> probabilities(test.rows() * tree.numClasses()), loadedProbabilities(probabilities.size());
+  tree.predictProba(test, probabilities.data());
+  loaded.predictProba(test, loadedProbabilities.data());
+  check(probabilities == loadedProbabilities, "tree: probabilities");
+  check(loaded.schema().labels == tree.schema().labels && loaded.schema().domains == tree.schema().domains, "tree: schema");
+
+  const std::string bagFile = modelPath("bag.model");
+  const Bagging bag(dr.get(), 5, 1234, options);
+  bag.save(bagFile);
+  const Bagging loadedBag = Bagging::load(bagFile, options);
+  bag.predict(test, expected.data());
+  loadedBag.predict(test, predicted.data());
+  check(expected == predicted, "bag: predictions");
+
+  //a small tree keeps the number of damaged files low
+  options.maxDepth = 3;
+  const DecisionTree small(dr.get(), options);
+  small.save(treeFile);
+  damagedFiles(treeFile);
+
+  std::filesystem::remove(treeFile);
+  std::filesystem::remove(bagFile);
+  return TestData::failures;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "OutOfCore.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * A tree trained out of core grows the tree of the histogram splitter in
+ * memory when its sample holds every row, so both use the same bins: with a
+ * large budget, and with a budget so small that the row assignments go to
+ * disk and every pass handles one node.
+ */
+
+namespace {
+
+/**
+ * Method that compares the out-of-core tree with the tree trained in memory.
+ *
+ * @return - passes over the file
+ */
+size_t sameAsInMemory(const Dataset& dataset, DataReader& dr, size_t budget, const std::string& name) {
+  TreeOptions options;
+  options.threads = 1;
+  options.splitter = Splitter::Histogram;
+  const DecisionTree memory(&dr, options);
+  options.memoryBudget = budget;
+  const DecisionTree streamed = DecisionTree::trainOutOfCore(dataset.train.filename, dataset.classLabel, options);
+
+  const DataTable& test = dr.testData();
+  std::vector<Category> expected(test.rows()), predicted(test.rows());
+  memory.predict(test, expected.data());
+  streamed.predict(test, predicted.data());
+  check(streamed.schema().labels == memory.schema().labels && streamed.schema().domains == memory.schema().domains, name + ": schema");
+  check(streamed.flat().size() == memory.flat().size(), name + ": tree size");
+  check(expected == predicted, name + ": predictions");
+  return OutOfCore::train(dataset.train.filename, dataset.classLabel, options).passes;
+}
+
+} // namespace
+
+int main() {
+  const auto directory = std::filesystem::temp_directory_path();
+  const std::string prefix = "decisiontree-outofcore-test-" + std::to_string(getpid());
+  Dataset dataset;
+  dataset.train.filename = (directory / (prefix + "-train.arff")).string();
+  dataset.test.filename = (directory / (prefix + "-test.arff")).string();
+  dataset.classLabel = "class";
+
+  //at most 2048 rows, the smallest sample, so the bins are those of all rows
+  TestData::Shape shape;
+  shape.rows = 2000;
+  TestData::Shape test = shape;
+  test.rows = 500;
+  TestData::writeArff(dataset.train.filename, shape, TestData::table(shape, 1));
+  TestData::writeArff(dataset.test.filename, test, TestData::table(test, 2));
+  DataReader dr(dataset);
+
+  const size_t passes = sameAsInMemory(dataset, dr, TreeOptions().memoryBudget, "large budget");
+  check(sameAsInMemory(dataset, dr, 16 << 10, "small budget") > passes, "small budget: one node per pass");
+
+  std::filesystem::remove(dataset.train.filename);
+  std::filesystem::remove(dataset.test.filename);
+  return TestData::failures;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <random>
+#include "Calculations.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * The presorted split search finds the same question as the exact one, which
+ * sorts the rows of every node again, and grows the same tree.
+ */
+
+namespace {
+
+bool sameQuestion(const Question& a, const Question& b) {
+  return a.column_ == b.column_ && a.numeric_ == b.numeric_
+      && (a.numeric_ ? a.threshold_ == b.threshold_ : a.categories_ == b.categories_);
+}
+
+/**
+ * Method that compares the exact split search with the presorted one, which
+ * has to find the same question on every subset of the rows.
+ */
+void presortedMatchesExact() {
+  for (size_t trial = 0; trial < 50; trial++) {
+    TestData::Shape shape;
+    shape.rows = 50 + trial * 10;
+    const DataTable data = TestData::table(shape, 100 + trial);
+    const auto columns = Calculations::allColumns(data);
+
+    std::mt19937_64 random(trial);
+    std::vector<size_t> rows;
+    for (size_t row = 0; row < data.rows(); row++)
+      if (random() % 3 != 0)
+        rows.push_back(row);
+    std::vector<int> weights(data.rows());
+    for (auto& weight: weights)
+      weight = 1 + random() % 3;
+    const int* weighted = trial % 2 ? weights.data() : nullptr;
+
+    const auto [exactGain, exact] = Calculations::find_best_split(data, rows, weighted, columns, 1 + trial % 3);
+    const auto sorted = Calculations::presort(data, rows);
+    const auto [presortedGain, presorted] = Calculations::find_best_split(data, sorted, 0, rows.size(), weighted, columns, 1 + trial % 3);
+
+    const std::string name = "presorted, trial " + std::to_string(trial);
+    check(std::abs(exactGain - presortedGain) < 1e-12, name + ": gain");
+    check(sameQuestion(exact, presorted), name + ": question");
+  }
+}
+
+} // namespace
+
+int main() {
+  presortedMatchesExact();
+
+  TestData::Shape shape;
+  shape.rows = 2000;
+  TestData::sameTree(shape, 1, Splitter::Presorted, "presorted tree");
+  return TestData::failures;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "Calculations.hpp"
+#include "DecisionTree.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+using TestData::answers;
+
+/*
+ * The split search on the non-zeros of a sparse table agrees with the search
+ * on the same table stored densely, and the exact splitter, which uses the
+ * sparse index of the training data, grows the tree of the presorted one,
+ * which does not.
+ */
+
+namespace {
+
+/**
+ * Method that compares the split search on a sparse table with the search on
+ * the same table without its sparse index. Zeros sit between the negative
+ * and the positive values, so both sides of them are searched.
+ */
+void sparseMatchesDense() {
+  for (size_t trial = 0; trial < 50; trial++) {
+    TestData::Shape shape;
+    shape.rows = 100 + trial * 20;
+    shape.numeric = 12;
+    shape.categorical = trial % 2;
+    shape.density = 0.1;
+    shape.missing = trial % 3 == 0 ? 0.02 : 0;
+    DataTable sparse = TestData::table(shape, 200 + trial);
+    const DataTable dense = sparse;
+    sparse.indexSparse();
+    check(sparse.isSparse() && !dense.isSparse(), "sparse, trial " + std::to_string(trial) + ": index");
+    const auto columns = Calculations::allColumns(dense);
+
+    std::mt19937_64 random(trial);
+    std::vector<size_t> rows;
+    for (size_t row = 0; row < dense.rows(); row++)
+      if (random() % 2 == 0)
+        rows.push_back(row);
+    std::vector<int> weights(dense.rows());
+    for (auto& weight: weights)
+      weight = 1 + random() % 3;
+    const int* weighted = trial % 2 ? weights.data() : nullptr;
+
+    const auto [denseGain, denseQuestion] = Calculations::find_best_split(dense, rows, weighted, columns, 1 + trial % 4);
+    const auto [sparseGain, sparseQuestion] = Calculations::find_best_split(sparse, rows, weighted, columns, 1 + trial % 4);
+
+    //a threshold anywhere between the same two values splits the rows alike
+    const std::string name = "sparse, trial " + std::to_string(trial);
+    check(std::abs(denseGain - sparseGain) < 1e-12, name + ": gain");
+    check(denseQuestion.column_ == sparseQuestion.column_, name + ": column");
+    check(answers(dense, rows, denseQuestion) == answers(dense, rows, sparseQuestion), name + ": partition");
+  }
+}
+
+} // namespace
+
+int main() {
+  sparseMatchesDense();
+
+  TestData::Shape sparse;
+  sparse.rows = 2000;
+  sparse.numeric = 20;
+  sparse.density = 0.1;
+  sparse.missing = 0.01;
+  TestData::sameTree(sparse, 2, Splitter::Presorted, "sparse tree");
+
+  return TestData::failures;
+}
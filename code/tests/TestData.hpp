@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_TESTDATA_HPP
+#define DECISIONTREE_TESTDATA_HPP
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include "DataReader.hpp"
+#include "DataTable.hpp"
+#include "DecisionTree.hpp"
+#include "IndexRange.hpp"
+#include "Question.hpp"
+#include "Utils.hpp"
+
+/**
+ * Helpers shared by the behaviour tests: random data tables built in code,
+ * written to ARFF files when a test needs a DataReader, comparisons of splits
+ * and trees, and a check that counts the failures. Every test is an executable that returns the number
+ * of failed checks, see tests/CMakeLists.txt.
+ */
+namespace TestData {
+
+inline int failures = 0;
+
+inline void check(bool condition, const std::string& what) {
+  if (condition)
+    return;
+  std::cerr << "FAILED: " << what << std::endl;
+  failures++;
+}
+
+/**
+ * Shape of a random table. Numeric columns come first, their values are
+ * multiples of 0.25 in [-4, 4], so there are ties and negative values; a
+ * share of them is missing ('?', read as -infinity) and with a density below
+ * 1 the others are 0. The class depends on the first columns, plus noise.
+ */
+struct Shape {
+  size_t rows = 500;
+  size_t numeric = 4;
+  size_t categorical = 2;
+  size_t cardinality = 6;
+  size_t classes = 3;
+  double density = 1; // share of the numeric values that are not 0
+  double missing = 0.05; // share of the numeric values that are missing
+  double noise = 0.2; // share of the rows with a random class
+};
+
+inline MetaData meta(const Shape& shape) {
+  MetaData meta;
+  for (size_t i = 0; i < shape.numeric; i++) {
+    meta.labels.push_back("n" + std::to_string(i));
+    meta.labelMap[meta.labels.back()] = "NUMERIC";
+  }
+  for (size_t i = 0; i < shape.categorical; i++) {
+    meta.labels.push_back("c" + std::to_string(i));
+    meta.labelMap[meta.labels.back()] = "CATEGORICAL";
+    for (size_t value = 0; value < shape.cardinality; value++)
+      meta.domains[meta.labels.back()].push_back("v" + std::to_string(value));
+  }
+  meta.labels.push_back("class");
+  meta.labelMap["class"] = "CATEGORICAL";
+  for (size_t value = 0; value < shape.classes; value++)
+    meta.domains["class"].push_back(std::to_string(value));
+  return meta;
+}
+
+/**
+ * Method that builds a random table, the same seed gives the same table.
+ * Category and class ids are the indexes of their declared values.
+ */
+inline DataTable table(const Shape& shape, uint64_t seed) {
+  DataTable data(meta(shape));
+  std::mt19937_64 random(seed);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::uniform_int_distribution<int> steps(-16, 16);
+  std::uniform_int_distribution<size_t> category(0, shape.cardinality - 1);
+  std::uniform_int_distribution<size_t> anyClass(0, shape.classes - 1);
+
+  for (size_t row = 0; row < shape.rows; row++) {
+    double score = 0;
+    for (size_t column = 0; column < shape.numeric; column++) {
+      float value = 0;
+      if (uniform(random) < shape.missing)
+        value = -std::numeric_limits<float>::infinity();
+      else if (uniform(random) < shape.density)
+        value = 0.25f * steps(random);
+      data.append(column, value);
+      if (column < 2 && std::isfinite(value))
+        score += (value + 4) / 8;
+    }
+    for (size_t column = 0; column < shape.categorical; column++) {
+      const size_t value = category(random);
+      data.append(shape.numeric + column, "v" + std::to_string(value));
+      if (column < 1)
+        score += static_cast<double>(value % 3) / 2;
+    }
+
+    size_t label = std::min<size_t>(score / 3 * shape.classes, shape.classes - 1);
+    if (uniform(random) < shape.noise)
+      label = anyClass(random);
+    data.appendClass(std::to_string(label));
+  }
+  return data;
+}
+
+/**
+ * Method that writes a table as an ARFF file with the columns of shape.
+ */
+inline void writeArff(const std::string& filename, const Shape& shape, const DataTable& data) {
+  std::ofstream file(filename);
+  file << "@RELATION test\n\n";
+  const MetaData columns = meta(shape);
+  for (size_t column = 0; column < data.columns(); column++) {
+    file << "@ATTRIBUTE " << columns.labels[column];
+    if (data.isNumeric(column)) {
+      file << " NUMERIC\n";
+      continue;
+    }
+    file << " {";
+    for (size_t value = 0; value < shape.cardinality; value++)
+      file << (value > 0 ? "," : "") << "v" << value;
+    file << "}\n";
+  }
+  file << "@ATTRIBUTE class {";
+  for (size_t value = 0; value < shape.classes; value++)
+    file << (value > 0 ? "," : "") << value;
+  file << "}\n\n@DATA\n";
+
+  for (size_t row = 0; row < data.rows(); row++) {
+    for (size_t column = 0; column < data.columns(); column++) {
+      if (!data.isNumeric(column))
+        file << data.dictionary(column)[data.categories(column)[row]] << ",";
+      else if (std::isinf(data.numeric(column)[row]))
+        file << "?,";
+      else
+        file << data.numeric(column)[row] << ",";
+    }
+    file << data.classNames()[data.classes()[row]] << "\n";
+  }
+}
+
+/**
+ * Method that reads random training and test tables through a DataReader, as
+ * the trees and bags are trained from one. The files are removed once read.
+ */
+inline std::unique_ptr<DataReader> reader(const Shape& shape, uint64_t seed) {
+  const auto directory = std::filesystem::temp_directory_path();
+  const std::string prefix = "decisiontree-test-" + std::to_string(getpid()) + "-" + std::to_string(seed);
+  Dataset dataset;
+  dataset.train.filename = (directory / (prefix + "-train.arff")).string();
+  dataset.test.filename = (directory / (prefix + "-test.arff")).string();
+  dataset.classLabel = "class";
+
+  Shape test = shape;
+  test.rows = std::max<size_t>(shape.rows / 4, 1);
+  writeArff(dataset.train.filename, shape, table(shape, seed));
+  writeArff(dataset.test.filename, test, table(test, seed + 1));
+  auto dr = std::make_unique<DataReader>(dataset);
+  std::filesystem::remove(dataset.train.filename);
+  std::filesystem::remove(dataset.test.filename);
+  return dr;
+}
+
+/**
+ * Method that returns, for every row, whether it answers the question.
+ */
+inline std::vector<bool> answers(const DataTable& data, IndexRange rows, const Question& question) {
+  std::vector<bool> result(rows.size());
+  for (size_t i = 0; i < rows.size(); i++)
+    result[i] = question.solve(data, rows[i]);
+  return result;
+}
+
+/**
+ * Method that trains a tree with the exact splitter and with another one on
+ * the same data, they have to grow the same tree.
+ */
+inline void sameTree(const Shape& shape, uint64_t seed, Splitter splitter, const std::string& name) {
+  const auto dr = reader(shape, seed);
+  TreeOptions exactOptions;
+  exactOptions.threads = 1;
+  TreeOptions otherOptions = exactOptions;
+  otherOptions.splitter = splitter;
+  const DecisionTree exact(dr.get(), exactOptions);
+  const DecisionTree other(dr.get(), otherOptions);
+
+  const DataTable& test = dr->testData();
+  std::vector<Category> expected(test.rows()), predicted(test.rows());
+  exact.predict(test, expected.data());
+  other.predict(test, predicted.data());
+  check(exact.flat().size() == other.flat().size(), name + ": tree size");
+  check(expected == predicted, name + ": predictions");
+}
+
+} // namespace TestData
+
+#endif //DECISIONTREE_TESTDATA_HPP
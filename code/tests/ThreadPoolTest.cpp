@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "ThreadPool.hpp"
+#include "TestData.hpp"
+
+using TestData::check;
+
+/*
+ * Recursive tasks can wait for their children without deadlocking, and a
+ * waiting task only helps with the tasks of its own group.
+ */
+
+namespace {
+
+long sum(ThreadPool& pool, long begin, long end) {
+  if (end - begin <= 16)
+    return (begin + end - 1) * (end - begin) / 2;
+  const long middle = begin + (end - begin) / 2;
+  auto left = pool.submit([&pool, begin, middle]() { return sum(pool, begin, middle); });
+  const long right = sum(pool, middle, end);
+  return pool.wait(left) + right;
+}
+
+void recursiveTasksFinish() {
+  ThreadPool pool(4);
+  check(sum(pool, 0, 100000) == 4999950000L, "recursive sum");
+
+  std::vector<std::future<long>> sums;
+  for (long i = 0; i < 8; i++)
+    sums.push_back(pool.submit([&pool, i]() { return sum(pool, 0, 1000 * (i + 1)); }));
+  for (long i = 0; i < 8; i++)
+    check(pool.wait(sums[i]) == 1000 * (i + 1) * (1000 * (i + 1) - 1) / 2, "concurrent recursive sum " + std::to_string(i));
+}
+
+/**
+ * Method that waits inside a task while an unrelated task was queued after
+ * its child. On a pool of one thread the caller runs every task, newest
+ * first, so the unrelated task would run inside the wait if helping was not
+ * limited to the group of the waiting task.
+ */
+void waitingHelpsOwnGroupOnly() {
+  ThreadPool pool(1);
+  bool waiting = false, helpedOther = false, ranChild = false;
+  std::future<void> other;
+  auto task = pool.submit([&]() {
+    auto child = pool.submit([&]() { ranChild = true; });
+    std::thread([&]() { other = pool.submit([&]() { helpedOther = waiting; }); }).join();
+    waiting = true;
+    pool.wait(child);
+    waiting = false;
+  });
+
+  pool.wait(task);
+  pool.wait(other);
+  check(ranChild, "child of the waiting task");
+  check(!helpedOther, "no unrelated task inside a wait");
+}
+
+} // namespace
+
+int main() {
+  recursiveTasksFinish();
+  waitingHelpsOwnGroupOnly();
+  return TestData::failures;
+}